@@ -0,0 +1,605 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include "biword.h"
+#include "indexer.h"
+#include "pruning.h"
+#include "query_shapes.h"
+#include "ranker.h"
+#include "segment.h"
+
+namespace {
+
+// Frequent terms from the Gutenberg texts behind data/10k
+const std::vector<std::string> DEFAULT_QUERIES = {
+    "whale",
+    "elizabeth",
+    "whale ship",
+    "upon time",
+    "captain ahab",
+    "great little long good",
+    "whale upon ship sea time little great long good",
+    "elizabeth darcy bennet sister love",
+    "holmes watson door room house street",
+    "life death night day heart eyes hand",
+    "man old young men world father mother",
+    "like well upon must time such little",
+};
+
+// Warm-start benchmark: p99 is taken per window of queries; the
+// full snapshot must serve STEADY_WINDOWS windows before stopping
+const size_t WARM_WINDOW_QUERIES = 100;
+const int STEADY_WINDOWS = 20;
+
+// A window is "settled" within this factor of the steady-state p99
+const double SETTLED_P99_RATIO = 1.2;
+
+struct QueryShape {
+    std::string name;
+    bool phrase;
+    std::vector<std::string> queries;
+};
+
+const std::vector<QueryShape> SHAPES = {
+    {"1-term",        false, {"whale", "elizabeth", "upon", "ship", "time", "little"}},
+    {"2-term OR",     false, {"whale ship", "upon time", "captain ahab", "great little",
+                              "elizabeth darcy", "holmes watson"}},
+    {"3-term OR",     false, {"whale upon ship", "little great long", "elizabeth darcy bennet",
+                              "life death night", "man old young", "sea boat water"}},
+    {"2-term phrase", true,  {"white whale", "captain ahab", "sperm whale", "miss bennet",
+                              "sherlock holmes", "old man"}},
+    {"3-term phrase", true,  {"white whale ahab", "mrs bennet daughters", "old man sea",
+                              "mr sherlock holmes", "sperm whale fishery", "poor old man"}},
+};
+
+// Filtered query terms in order, without de-duplication (phrases)
+std::vector<std::string> phraseTerms(const std::string& query) {
+    std::vector<std::string> terms;
+    for (const auto& token : tokenize(query)) {
+        if (!stopWords.count(token)) terms.push_back(token);
+    }
+    return terms;
+}
+
+double percentile(std::vector<double> sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+// Stop-word filtered, de-duplicated terms (same as the ranked path)
+std::vector<std::string> rankedTerms(const std::string& query) {
+    std::unordered_set<std::string> deduped;
+    std::vector<std::string> terms;
+
+    for (const auto& token : tokenize(query)) {
+        if (stopWords.count(token)) continue;
+        if (deduped.insert(token).second) terms.push_back(token);
+    }
+    return terms;
+}
+
+void printLatencies(const std::string& label, std::vector<double> micros, double wallMs) {
+    std::sort(micros.begin(), micros.end());
+
+    double sum = 0.0;
+    for (double v : micros) sum += v;
+
+    std::cout << label
+              << " | avg " << (micros.empty() ? 0.0 : sum / micros.size()) << " us"
+              << " | p50 " << percentile(micros, 0.50) << " us"
+              << " | p95 " << percentile(micros, 0.95) << " us"
+              << " | p99 " << percentile(micros, 0.99) << " us";
+    if (wallMs > 0) {
+        std::cout << " | " << micros.size() / (wallMs / 1000.0) << " qps";
+    }
+    std::cout << "\n";
+}
+
+}  // namespace
+
+std::vector<std::string> loadBenchQueries(const std::string& filename) {
+    std::vector<std::string> queries;
+
+    if (!filename.empty()) {
+        std::ifstream in(filename);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty()) queries.push_back(line);
+        }
+        if (queries.empty()) {
+            std::cerr << "No queries in " << filename << ", using defaults\n";
+        }
+    }
+
+    if (queries.empty()) queries = DEFAULT_QUERIES;
+    return queries;
+}
+
+void runQueryBenchmark(
+    SnapshotManager& snapshots,
+    QueryScheduler& scheduler,
+    const std::vector<std::string>& queries,
+    const QueryBenchOptions& options
+) {
+    std::shared_ptr<const IndexSnapshot> snapshot = snapshots.acquire();
+
+    std::vector<std::vector<std::string>> termSets;
+    for (const auto& q : queries) termSets.push_back(rankedTerms(q));
+
+    using Clock = std::chrono::high_resolution_clock;
+    auto micros = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::micro>(b - a).count();
+    };
+
+    std::cout << "\n=== Query benchmark: " << queries.size() << " queries x "
+              << options.runsPerQuery << " runs, K=" << options.K
+              << ", " << options.clients << " client(s), "
+              << scheduler.pool().size() << " pool worker(s), "
+              << snapshot->partitions.size() << " partition(s) ===\n";
+
+    /* --------------------------------------------------
+       1) SERIAL BASELINE (rankDocuments, one client)
+       -------------------------------------------------- */
+    std::vector<std::vector<std::pair<int,double>>> expected(termSets.size());
+    std::vector<double> baseline;
+
+    auto baseStart = Clock::now();
+    for (int run = 0; run < options.runsPerQuery; run++) {
+        for (size_t q = 0; q < termSets.size(); q++) {
+            auto t0 = Clock::now();
+            expected[q] = rankDocuments(
+                termSets[q], snapshot->positionalIndex,
+                snapshot->docLength, snapshot->totalDocs, options.K
+            );
+            baseline.push_back(micros(t0, Clock::now()));
+        }
+    }
+    printLatencies("baseline (serial)    ", baseline, micros(baseStart, Clock::now()) / 1000.0);
+
+    /* --------------------------------------------------
+       2) SCHEDULED (N concurrent clients)
+       -------------------------------------------------- */
+    std::vector<double> scheduled;
+    std::mutex resultsMutex;
+    std::atomic<int> mismatches{0};
+    std::atomic<int> partial{0};
+
+    std::unique_ptr<AdmissionController> admission;
+    if (options.sloMs > 0) {
+        unsigned int slots = options.maxConcurrent ? options.maxConcurrent
+                                                   : static_cast<unsigned int>(scheduler.pool().size());
+        admission = std::make_unique<AdmissionController>(
+            slots, std::chrono::milliseconds(options.sloMs)
+        );
+    }
+
+    auto before = scheduler.stats();
+    auto schedStart = Clock::now();
+
+    std::vector<std::thread> clients;
+    for (unsigned int c = 0; c < options.clients; c++) {
+        clients.emplace_back([&, c]() {
+            std::vector<double> local;
+
+            for (int run = 0; run < options.runsPerQuery; run++) {
+                for (size_t i = 0; i < termSets.size(); i++) {
+                    size_t q = (i + c) % termSets.size();  // stagger clients
+
+                    auto t0 = Clock::now();
+                    if (admission && !admission->acquire()) continue;  // shed
+
+                    QueryBudget budget;
+                    auto started = Clock::now();
+                    if (options.deadlineMs > 0) {
+                        budget.deadline = std::chrono::steady_clock::now() +
+                                          std::chrono::milliseconds(options.deadlineMs);
+                    }
+                    if (options.maxPostings > 0) budget.maxPostings = options.maxPostings;
+
+                    auto results = scheduler.rank(*snapshot, termSets[q], options.K, &budget);
+                    auto t1 = Clock::now();
+                    local.push_back(micros(t0, t1));
+
+                    if (admission) {
+                        admission->release(std::chrono::duration_cast<std::chrono::microseconds>(t1 - started));
+                    }
+
+                    if (budget.exhausted) {
+                        partial++;
+                        continue;
+                    }
+                    if (results.size() != expected[q].size()) {
+                        mismatches++;
+                        continue;
+                    }
+                    for (size_t r = 0; r < results.size(); r++) {
+                        if (results[r].first != expected[q][r].first) {
+                            mismatches++;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            scheduled.insert(scheduled.end(), local.begin(), local.end());
+        });
+    }
+    for (auto& t : clients) t.join();
+
+    printLatencies("scheduled            ", scheduled, micros(schedStart, Clock::now()) / 1000.0);
+
+    auto after = scheduler.stats();
+    std::cout << "intra-query split: " << (after.parallelQueries - before.parallelQueries)
+              << " queries (" << (after.tasks - before.tasks) << " tasks), serial: "
+              << (after.serialQueries - before.serialQueries) << " queries\n";
+    std::cout << "result mismatches vs baseline: " << mismatches.load() << "\n";
+
+    if (options.deadlineMs > 0 || options.maxPostings > 0) {
+        std::cout << "partial results (budget exhausted): " << partial.load()
+                  << " of " << scheduled.size() << " answered\n";
+    }
+    if (admission) {
+        auto admitted = admission->stats();
+        std::cout << "admission (slo " << options.sloMs << " ms): "
+                  << admitted.admitted << " admitted, " << admitted.queued << " queued, "
+                  << admitted.shed << " shed\n";
+    }
+}
+
+void runShapeBenchmark(
+    SnapshotManager& snapshots,
+    const QueryBenchOptions& options
+) {
+    std::shared_ptr<const IndexSnapshot> snapshot = snapshots.acquire();
+    if (snapshot->partitions.empty()) return;
+
+    using Clock = std::chrono::high_resolution_clock;
+    auto micros = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::micro>(b - a).count();
+    };
+
+    // Serial over partitions: isolates evaluator cost from scheduling
+    auto rankAll = [&](const std::vector<std::string>& terms, int K, bool specialized) {
+        std::vector<double> idfs;
+        for (const auto& term : terms) {
+            auto it = snapshot->positionalIndex.find(term);
+            int df = it == snapshot->positionalIndex.end() ? 0 : static_cast<int>(it->second.size());
+            idfs.push_back(computeIDF(snapshot->totalDocs, df));
+        }
+
+        std::vector<std::vector<std::pair<int,double>>> partials;
+        std::vector<const std::vector<Posting>*> lists(terms.size());
+
+        for (const auto& partition : snapshot->partitions) {
+            for (size_t t = 0; t < terms.size(); t++) {
+                auto it = partition.postings.find(terms[t]);
+                lists[t] = it == partition.postings.end() ? nullptr : &it->second;
+            }
+            partials.push_back(specialized
+                ? rankPartition(partition, lists, idfs, snapshot->docLength, K)
+                : rankDocumentRange(lists, idfs, snapshot->docLength,
+                                    partition.docBegin, partition.docEnd, K));
+        }
+        return mergeTopK(partials, K);
+    };
+
+    std::cout << "\n=== Query shapes: generic vs specialized (avg / p99 us, "
+              << options.runsPerQuery << " runs) ===\n";
+
+    for (const auto& shape : SHAPES) {
+        std::vector<int> ks = shape.phrase ? std::vector<int>{0} : std::vector<int>{10, 100};
+
+        for (int K : ks) {
+            std::vector<double> generic, specialized, biword;
+            int mismatches = 0;
+
+            for (int run = 0; run < options.runsPerQuery; run++) {
+                for (const auto& query : shape.queries) {
+                    std::vector<std::string> terms =
+                        shape.phrase ? phraseTerms(query) : rankedTerms(query);
+
+                    auto t0 = Clock::now();
+                    if (shape.phrase) {
+                        auto a = matchPhraseGeneric(snapshot->positionalIndex, terms);
+                        auto t1 = Clock::now();
+                        auto b = matchPhrase(snapshot->positionalIndex, terms);
+                        auto t2 = Clock::now();
+                        generic.push_back(micros(t0, t1));
+                        specialized.push_back(micros(t1, t2));
+                        if (a != b) mismatches++;
+
+                        if (!snapshot->biwordIndex.empty()) {
+                            auto c = matchPhraseWithBiwords(
+                                snapshot->positionalIndex, snapshot->biwordIndex, terms
+                            );
+                            biword.push_back(micros(t2, Clock::now()));
+                            if (a != c) mismatches++;
+                        }
+                    } else {
+                        auto a = rankAll(terms, K, false);
+                        auto t1 = Clock::now();
+                        auto b = rankAll(terms, K, true);
+                        auto t2 = Clock::now();
+                        generic.push_back(micros(t0, t1));
+                        specialized.push_back(micros(t1, t2));
+                        if (a != b) mismatches++;
+                    }
+                }
+            }
+
+            std::sort(generic.begin(), generic.end());
+            std::sort(specialized.begin(), specialized.end());
+            std::sort(biword.begin(), biword.end());
+            auto avg = [](const std::vector<double>& v) {
+                double sum = 0.0;
+                for (double x : v) sum += x;
+                return v.empty() ? 0.0 : sum / v.size();
+            };
+
+            std::cout << shape.name;
+            if (!shape.phrase) std::cout << ", top-" << K;
+            std::cout << " | generic " << avg(generic) << " / " << percentile(generic, 0.99)
+                      << " | specialized " << avg(specialized) << " / " << percentile(specialized, 0.99)
+                      << " | speedup " << (avg(specialized) > 0 ? avg(generic) / avg(specialized) : 0.0)
+                      << "x";
+            if (!biword.empty()) {
+                std::cout << " | biword " << avg(biword) << " / " << percentile(biword, 0.99)
+                          << " (" << (avg(biword) > 0 ? avg(generic) / avg(biword) : 0.0) << "x)";
+            }
+            std::cout << " | mismatches " << mismatches << "\n";
+        }
+    }
+}
+
+void runTieredBenchmark(
+    SnapshotManager& snapshots,
+    TieredIndex& tiered,
+    const std::vector<std::string>& queries,
+    const QueryBenchOptions& options
+) {
+    std::shared_ptr<const IndexSnapshot> snapshot = snapshots.acquire();
+
+    using Clock = std::chrono::high_resolution_clock;
+    auto micros = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::micro>(b - a).count();
+    };
+
+    std::cout << "\n=== Tiered index: " << queries.size() << " queries x "
+              << options.runsPerQuery << " runs, K=" << options.K << ", "
+              << tiered.termCount() << " terms, segment "
+              << tiered.stats().mappedBytes / 1024 << " KB mapped ===\n";
+
+    // First pass is cold (every term decoded from the mapping)
+    std::vector<double> cold, warm;
+    int mismatches = 0;
+
+    for (int run = 0; run < options.runsPerQuery; run++) {
+        for (const auto& query : queries) {
+            std::vector<std::string> terms = rankedTerms(query);
+
+            auto t0 = Clock::now();
+            std::vector<std::pair<int,double>> results;
+            bool ranked = tiered.rank(
+                terms, snapshot->docLength, snapshot->totalDocs, options.K, results
+            );
+            (run == 0 ? cold : warm).push_back(micros(t0, Clock::now()));
+
+            auto expected = rankDocuments(
+                terms, snapshot->positionalIndex,
+                snapshot->docLength, snapshot->totalDocs, options.K
+            );
+            if (!ranked || results.size() != expected.size()) {
+                mismatches++;
+                continue;
+            }
+            for (size_t r = 0; r < results.size(); r++) {
+                if (results[r].first != expected[r].first) {
+                    mismatches++;
+                    break;
+                }
+            }
+        }
+    }
+
+    printLatencies("tiered (first pass)  ", cold, 0);
+    printLatencies("tiered (later passes)", warm, 0);
+
+    TieredIndex::Stats stats = tiered.stats();
+    unsigned long long lookups = stats.hits + stats.misses;
+
+    std::cout << "hot cache: " << stats.hotTerms << " terms, "
+              << stats.hotBytes / 1024 << " KB | hit rate "
+              << (lookups ? 100.0 * stats.hits / lookups : 0.0) << "% ("
+              << stats.hits << " hits, " << stats.misses << " misses, "
+              << stats.evictions << " evictions)\n";
+    std::cout << "process RSS: " << currentRssKb() / 1024 << " MB\n";
+    std::cout << "result mismatches vs baseline: " << mismatches << "\n";
+}
+
+void runWarmStartBenchmark(
+    SnapshotManager& snapshots,
+    QueryScheduler& scheduler,
+    const std::vector<std::string>& queries,
+    const QueryBenchOptions& options,
+    std::chrono::steady_clock::time_point processStart
+) {
+    using Clock = std::chrono::steady_clock;
+    auto millis = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+
+    std::vector<std::vector<std::string>> termSets;
+    for (const auto& q : queries) termSets.push_back(rankedTerms(q));
+
+    struct Window {
+        double endMs;
+        double p99;
+        bool bootstrap;
+    };
+
+    std::vector<Window> windows;
+    std::vector<double> current, bootstrapLatencies, fullLatencies;
+    double firstResultMs = -1.0;
+    double fullServingMs = -1.0;
+    int steadyWindows = 0;
+
+    for (size_t i = 0; steadyWindows < STEADY_WINDOWS; i++) {
+        std::shared_ptr<const IndexSnapshot> snapshot = snapshots.acquire();
+        const bool bootstrap = snapshot->tiered && snapshot->positionalIndex.empty();
+
+        // Give up if the background load failed
+        if (bootstrap && !snapshots.rebuilding() && snapshots.acquire() == snapshot) break;
+
+        auto t0 = Clock::now();
+        scheduler.rank(*snapshot, termSets[i % termSets.size()], options.K);
+        auto t1 = Clock::now();
+
+        double us = millis(t0, t1) * 1000.0;
+        if (firstResultMs < 0) firstResultMs = millis(processStart, t1);
+        if (!bootstrap && fullServingMs < 0) fullServingMs = millis(processStart, t0);
+
+        (bootstrap ? bootstrapLatencies : fullLatencies).push_back(us);
+        current.push_back(us);
+
+        if (current.size() == WARM_WINDOW_QUERIES) {
+            std::sort(current.begin(), current.end());
+            windows.push_back({millis(processStart, t1), percentile(current, 0.99), bootstrap});
+            current.clear();
+            if (!bootstrap) steadyWindows++;
+        }
+    }
+
+    std::cout << "\n=== Warm start: " << queries.size() << " queries replayed, windows of "
+              << WARM_WINDOW_QUERIES << " ===\n";
+    std::cout << "time to first query: " << firstResultMs << " ms (process start to first result)\n";
+    if (fullServingMs >= 0) {
+        std::cout << "full snapshot serving after: " << fullServingMs << " ms\n";
+    }
+
+    printLatencies("bootstrap (tiered)   ", bootstrapLatencies, 0);
+    printLatencies("full snapshot        ", fullLatencies, 0);
+
+    if (windows.empty() || steadyWindows < STEADY_WINDOWS) return;
+
+    // Steady state: median window p99 over the second half of the full-snapshot windows
+    std::vector<double> tail;
+    for (size_t w = windows.size() - STEADY_WINDOWS / 2; w < windows.size(); w++) {
+        tail.push_back(windows[w].p99);
+    }
+    std::sort(tail.begin(), tail.end());
+    const double steadyP99 = percentile(tail, 0.5);
+
+    // Settled once no later window exceeds the steady p99 by more than the ratio
+    double settledMs = windows.front().endMs;
+    for (size_t w = windows.size(); w-- > 0;) {
+        if (windows[w].p99 > SETTLED_P99_RATIO * steadyP99) {
+            settledMs = windows[w].endMs;
+            break;
+        }
+    }
+
+    std::cout << "steady-state p99: " << steadyP99 << " us, reached after "
+              << settledMs << " ms (window p99 within " << SETTLED_P99_RATIO << "x)\n";
+}
+
+void runPruningBenchmark(
+    SnapshotManager& snapshots,
+    const std::vector<std::string>& queries,
+    const QueryBenchOptions& options
+) {
+    std::shared_ptr<const IndexSnapshot> snapshot = snapshots.acquire();
+    const PrunedIndex& pruned = snapshot->prunedIndex;
+
+    using Clock = std::chrono::high_resolution_clock;
+    auto micros = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::micro>(b - a).count();
+    };
+
+    std::size_t fullPostings = 0, tier1Postings = 0;
+    for (const auto& [word, docMap] : snapshot->positionalIndex) fullPostings += docMap.size();
+    for (const auto& [word, term] : pruned) tier1Postings += term.postings.size();
+
+    std::cout << "\n=== Static pruning: " << queries.size() << " queries x "
+              << options.runsPerQuery << " runs, K=" << options.K << ", tier 1 keeps "
+              << tier1Postings << " / " << fullPostings << " postings ("
+              << (fullPostings ? 100.0 * tier1Postings / fullPostings : 0.0) << "%) ===\n";
+
+    std::vector<double> full, twoTier;
+    unsigned long long certified = 0, fallbacks = 0;
+    int mismatches = 0;
+
+    // Tier 1 alone, no safety check: fraction of the exact Top-K it finds
+    std::size_t tier1Found = 0, expectedTotal = 0;
+
+    for (int run = 0; run < options.runsPerQuery; run++) {
+        for (const auto& query : queries) {
+            std::vector<std::string> terms = rankedTerms(query);
+
+            auto t0 = Clock::now();
+            auto expected = rankDocuments(
+                terms, snapshot->positionalIndex,
+                snapshot->docLength, snapshot->totalDocs, options.K
+            );
+            auto t1 = Clock::now();
+
+            std::vector<std::pair<int,double>> results;
+            if (rankPruned(pruned, snapshot->positionalIndex, terms,
+                           snapshot->docLength, snapshot->totalDocs, options.K, results)) {
+                certified++;
+            } else {
+                fallbacks++;
+                results = rankDocuments(
+                    terms, snapshot->positionalIndex,
+                    snapshot->docLength, snapshot->totalDocs, options.K
+                );
+            }
+            auto t2 = Clock::now();
+
+            full.push_back(micros(t0, t1));
+            twoTier.push_back(micros(t1, t2));
+
+            if (results.size() != expected.size()) {
+                mismatches++;
+            } else {
+                for (size_t r = 0; r < results.size(); r++) {
+                    if (results[r].first != expected[r].first) {
+                        mismatches++;
+                        break;
+                    }
+                }
+            }
+
+            if (run > 0) continue;
+
+            auto approx = rankTier1Only(
+                pruned, terms, snapshot->docLength, snapshot->totalDocs, options.K
+            );
+            std::unordered_set<int> approxDocs;
+            for (const auto& r : approx) approxDocs.insert(r.first);
+            for (const auto& r : expected) tier1Found += approxDocs.count(r.first);
+            expectedTotal += expected.size();
+        }
+    }
+
+    printLatencies("full index           ", full, 0);
+    printLatencies("tier 1 + fallback    ", twoTier, 0);
+
+    unsigned long long total = certified + fallbacks;
+    std::cout << "certified from tier 1: " << certified << " / " << total << " ("
+              << (total ? 100.0 * certified / total : 0.0) << "%), fallbacks "
+              << fallbacks << "\n";
+    std::cout << "recall@" << options.K << " of tier 1 alone (no fallback): "
+              << (expectedTotal ? 100.0 * tier1Found / expectedTotal : 100.0) << "%\n";
+    std::cout << "result mismatches vs baseline (tier 1 + fallback): " << mismatches << "\n";
+}
@@ -0,0 +1,86 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "scheduler.h"
+#include "snapshot.h"
+#include "tiered_index.h"
+
+// ============================================================
+// In-memory query benchmark
+// ============================================================
+//
+// Replays a query set against the current snapshot with N
+// concurrent clients and reports latency percentiles. Console
+// I/O is excluded; every query is checked against the serial
+// rankDocuments() baseline.
+//
+// With a deadline / posting budget, queries that run out are
+// counted as partial instead of compared. With an SLO, clients
+// go through an AdmissionController and shed queries are counted.
+//
+struct QueryBenchOptions {
+    unsigned int clients = 1;
+    int runsPerQuery = 10;
+    int K = 10;
+
+    int deadlineMs = 0;           // 0: no per-query deadline
+    std::size_t maxPostings = 0;  // 0: no posting budget
+    int sloMs = 0;                // 0: no admission control
+    unsigned int maxConcurrent = 0;  // admission slots (0: pool size)
+};
+
+// One query per line; built-in set of heavy Gutenberg queries
+// when the file is empty or missing.
+std::vector<std::string> loadBenchQueries(const std::string& filename);
+
+void runQueryBenchmark(
+    SnapshotManager& snapshots,
+    QueryScheduler& scheduler,
+    const std::vector<std::string>& queries,
+    const QueryBenchOptions& options
+);
+
+// Per query shape (1/2/3-term OR at K=10/100, 2/3-term phrase):
+// generic evaluators vs the compile-time specialized ones
+void runShapeBenchmark(
+    SnapshotManager& snapshots,
+    const QueryBenchOptions& options
+);
+
+// Same queries served by a TieredIndex (hot LRU of decoded
+// postings + mmap'd cold segment): latency, cache hit rate and
+// RSS, with results checked against rankDocuments()
+void runTieredBenchmark(
+    SnapshotManager& snapshots,
+    TieredIndex& tiered,
+    const std::vector<std::string>& queries,
+    const QueryBenchOptions& options
+);
+
+// Static pruning (--prune): full-index latency vs tier 1 with the
+// exact fallback, how often tier 1 certifies the answer, and the
+// recall@K of tier 1 on its own. Uses the snapshot's prunedIndex.
+void runPruningBenchmark(
+    SnapshotManager& snapshots,
+    const std::vector<std::string>& queries,
+    const QueryBenchOptions& options
+);
+
+// Fast startup (--open): replays the queries back to back from the
+// moment the bootstrap snapshot is published until the full
+// snapshot has served a while. Reports time-to-first-query (from
+// processStart) and when the windowed p99 settles at steady state.
+void runWarmStartBenchmark(
+    SnapshotManager& snapshots,
+    QueryScheduler& scheduler,
+    const std::vector<std::string>& queries,
+    const QueryBenchOptions& options,
+    std::chrono::steady_clock::time_point processStart
+);
+
+#endif
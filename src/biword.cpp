@@ -0,0 +1,162 @@
+#include "biword.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "query_shapes.h"
+
+using std::string;
+using std::vector;
+
+using DocPositions = std::unordered_map<int, vector<int>>;
+
+string biwordKey(const string& first, const string& second) {
+    string key;
+    key.reserve(first.size() + 1 + second.size());
+    key.append(first).push_back(' ');
+    key.append(second);
+    return key;
+}
+
+PositionalIndex buildBiwordIndex(
+    const PositionalIndex& positionalIndex,
+    const std::unordered_map<int, int>& docLength,
+    int minFrequency
+) {
+    /* ------------------------------------------------------------
+       1) REBUILD EACH DOCUMENT'S TERM SEQUENCE (TERM IDS)
+       ------------------------------------------------------------ */
+    vector<const string*> terms;
+    terms.reserve(positionalIndex.size());
+
+    std::unordered_map<int, vector<int>> sequences;
+    for (const auto& [docID, len] : docLength) {
+        if (len > 0) sequences[docID].assign(len, -1);
+    }
+
+    for (const auto& [word, docMap] : positionalIndex) {
+        const int termID = static_cast<int>(terms.size());
+        terms.push_back(&word);
+
+        for (const auto& [docID, positions] : docMap) {
+            auto seqIt = sequences.find(docID);
+            if (seqIt == sequences.end()) continue;
+
+            for (int pos : positions) {
+                if (pos >= 0 && pos < static_cast<int>(seqIt->second.size())) {
+                    seqIt->second[pos] = termID;
+                }
+            }
+        }
+    }
+
+    auto pairKey = [](int a, int b) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+    };
+
+    /* ------------------------------------------------------------
+       2) COUNT PAIR FREQUENCIES
+       ------------------------------------------------------------ */
+    std::unordered_map<uint64_t, int> pairFrequency;
+    for (const auto& [docID, seq] : sequences) {
+        for (size_t p = 0; p + 1 < seq.size(); p++) {
+            if (seq[p] < 0 || seq[p + 1] < 0) continue;
+            pairFrequency[pairKey(seq[p], seq[p + 1])]++;
+        }
+    }
+
+    /* ------------------------------------------------------------
+       3) POSTINGS FOR FREQUENT PAIRS ONLY
+       ------------------------------------------------------------ */
+    PositionalIndex biwordIndex;
+    std::unordered_map<uint64_t, DocPositions*> slots;
+
+    for (const auto& [key, freq] : pairFrequency) {
+        if (freq < minFrequency) continue;
+
+        const string& first  = *terms[key >> 32];
+        const string& second = *terms[key & 0xFFFFFFFFu];
+        slots[key] = &biwordIndex[biwordKey(first, second)];
+    }
+
+    for (const auto& [docID, seq] : sequences) {
+        for (size_t p = 0; p + 1 < seq.size(); p++) {
+            if (seq[p] < 0 || seq[p + 1] < 0) continue;
+
+            auto slot = slots.find(pairKey(seq[p], seq[p + 1]));
+            if (slot != slots.end()) {
+                (*slot->second)[docID].push_back(static_cast<int>(p));
+            }
+        }
+    }
+
+    return biwordIndex;
+}
+
+vector<int> matchPhraseWithBiwords(
+    const PositionalIndex& positionalIndex,
+    const PositionalIndex& biwordIndex,
+    const vector<string>& terms
+) {
+    if (terms.size() < 2 || biwordIndex.empty()) {
+        return matchPhrase(positionalIndex, terms);
+    }
+
+    // Biword posting per consecutive pair (null: not indexed)
+    vector<const DocPositions*> pairMaps(terms.size() - 1, nullptr);
+    size_t seed = pairMaps.size();
+
+    for (size_t i = 0; i + 1 < terms.size(); i++) {
+        auto it = biwordIndex.find(biwordKey(terms[i], terms[i + 1]));
+        if (it == biwordIndex.end()) continue;
+
+        pairMaps[i] = &it->second;
+        if (seed == pairMaps.size() || it->second.size() < pairMaps[seed]->size()) {
+            seed = i;
+        }
+    }
+
+    if (seed == pairMaps.size()) {
+        return matchPhrase(positionalIndex, terms);
+    }
+
+    // Positional postings for the pairs that are not indexed
+    vector<const DocPositions*> termMaps(terms.size(), nullptr);
+    for (size_t i = 0; i + 1 < terms.size(); i++) {
+        if (pairMaps[i]) continue;
+
+        for (size_t t : {i, i + 1}) {
+            if (termMaps[t]) continue;
+            auto it = positionalIndex.find(terms[t]);
+            if (it == positionalIndex.end()) return {};
+            termMaps[t] = &it->second;
+        }
+    }
+
+    vector<int> matchingDocs;
+
+    for (const auto& docPair : *pairMaps[seed]) {
+        const int docID = docPair.first;
+        bool matchesAll = true;
+
+        for (size_t i = 0; i + 1 < terms.size() && matchesAll; i++) {
+            if (i == seed) continue;
+
+            if (pairMaps[i]) {
+                matchesAll = pairMaps[i]->count(docID) > 0;
+                continue;
+            }
+
+            auto p1 = termMaps[i]->find(docID);
+            auto p2 = termMaps[i + 1]->find(docID);
+            matchesAll = p1 != termMaps[i]->end() &&
+                         p2 != termMaps[i + 1]->end() &&
+                         phraseMatchTwoWords(p1->second, p2->second);
+        }
+
+        if (matchesAll) matchingDocs.push_back(docID);
+    }
+
+    std::sort(matchingDocs.begin(), matchingDocs.end());
+    return matchingDocs;
+}
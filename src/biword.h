@@ -0,0 +1,42 @@
+#ifndef BIWORD_H
+#define BIWORD_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "indexer.h"
+
+// ============================================================
+// Biword (next-word) auxiliary index
+// ============================================================
+//
+// Maps an adjacent term pair "w1 w2" to { docID -> [pos of w1] },
+// using the post-stop-word positions assigned by indexDocuments.
+// Only pairs occurring at least minFrequency times in the corpus
+// are kept: those are the ones whose positional merge is costly,
+// while rare pairs stay cheap to verify from the main index.
+//
+
+// Key used in the biword index for the pair (first, second)
+std::string biwordKey(const std::string& first, const std::string& second);
+
+// Builds the biword index from a positional index. docLength
+// gives each document's token count (positions 0..len-1).
+PositionalIndex buildBiwordIndex(
+    const PositionalIndex& positionalIndex,
+    const std::unordered_map<int, int>& docLength,
+    int minFrequency
+);
+
+// Phrase matching (same pairwise-adjacency rule as matchPhrase).
+// Pairs present in the biword index are answered by lookup; the
+// rarest biword seeds the candidates. Falls back to matchPhrase()
+// when no pair of the phrase is indexed.
+std::vector<int> matchPhraseWithBiwords(
+    const PositionalIndex& positionalIndex,
+    const PositionalIndex& biwordIndex,
+    const std::vector<std::string>& terms
+);
+
+#endif
@@ -0,0 +1,454 @@
+#include "indexer.h"
+
+#include <iostream>
+#include <fstream>
+#include <cctype>
+#include <mutex>
+#include <thread>
+#include <filesystem>
+#include <algorithm>
+
+// ============================================================
+// Tokenizer
+// ============================================================
+//
+// Purpose:
+// - Normalizes text for indexing and querying
+// - Produces consistent tokens across documents and queries
+//
+// Rules:
+// - Converts all characters to lowercase
+// - Treats any non-alphanumeric character as a delimiter
+// - Splits on whitespace and punctuation
+// - Ignores tokens with length < 2
+//
+// Notes:
+// - Used for both document indexing and query processing
+// - Token *positions* are tracked by the caller (important for
+//   positional inverted index and phrase queries)
+// - This function itself is stateless and thread-safe
+//
+std::vector<std::string> tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    std::string current;
+    current.reserve(16);  // Small optimization to reduce reallocations
+
+    for (unsigned char ch : text) {
+        char c = static_cast<char>(std::tolower(ch));
+
+        if (std::isalnum(c)) {
+            current.push_back(c);
+        } else {
+            // Delimiter encountered: flush current token
+            if (current.size() >= 2) {
+                tokens.push_back(current);
+            }
+            current.clear();
+        }
+    }
+
+    // Flush final token if present
+    if (current.size() >= 2) {
+        tokens.push_back(current);
+    }
+
+    return tokens;
+}
+
+
+/// STEP 4: Stop word list
+// ---------------------
+// Purpose:
+// - Removes high-frequency, low-information words from indexing and queries
+// - Improves ranking quality and reduces index size
+//
+// Notes:
+// - Stop words are applied consistently during:
+//   1) Document indexing
+//   2) Query processing
+// - Phrase queries preserve token order *after* stop-word removal
+
+std::unordered_set<std::string> stopWords = {
+
+    /* --------------------
+       Articles
+       -------------------- */
+    "a", "an", "the",
+
+    /* --------------------
+       Pronouns
+       -------------------- */
+    "i","me","my","mine","myself",
+    "you","your","yours","yourself","yourselves",
+    "he","him","his","himself",
+    "she","her","hers","herself",
+    "it","its","itself",
+    "we","us","our","ours","ourselves",
+    "they","them","their","theirs","themselves",
+    "one","ones","someone","anyone","everyone","nobody","nothing","something",
+
+    /* --------------------
+       Auxiliary & Modal Verbs
+       -------------------- */
+    "am","is","are","was","were",
+    "be","been","being",
+    "have","has","had","having",
+    "do","does","did","doing",
+    "will","would","shall","should",
+    "can","could","may","might","must","ought",
+
+    /* --------------------
+       Common Verb Noise
+       -------------------- */
+    "say","says","said","saying",
+    "get","gets","got","getting",
+    "make","makes","made","making",
+    "go","goes","went","going",
+    "know","knows","knew","knowing",
+    "think","thinks","thought","thinking",
+    "see","sees","saw","seeing",
+    "come","comes","came","coming",
+    "take","takes","took","taking",
+    "use","uses","used","using",
+    "find","finds","found","finding",
+    "give","gives","gave","giving",
+    "tell","tells","told","telling",
+    "work","works","worked","working",
+    "seem","seems","seemed","seeming",
+    "try","tries","tried","trying",
+    "leave","leaves","left","leaving",
+    "call","calls","called","calling",
+    "start","starts","started","starting",
+    "end","ends","ended","ending",
+    "show","shows","showed","showing",
+    "play","plays","played","playing",
+    "run","runs","ran","running",
+    "move","moves","moved","moving",
+
+    /* --------------------
+       Conjunctions
+       -------------------- */
+    "and","or","but","if","while","because","as",
+    "until","unless","although","though","whereas",
+    "whether","nor","yet","so",
+
+    /* --------------------
+       Prepositions
+       -------------------- */
+    "of","to","in","on","at","by","for","with",
+    "about","against","between","into","through",
+    "during","before","after","above","below",
+    "from","up","down","out","off","over","under",
+    "within","without","across","behind","beyond",
+    "near","along","among","around","toward","towards",
+
+    /* --------------------
+       Determiners & Quantifiers
+       -------------------- */
+    "this","that","these","those",
+    "each","every","either","neither",
+    "some","any","no","none","all","both",
+    "many","much","few","several","most","least",
+    "such","same","other","another",
+
+    /* --------------------
+       Adverbs
+       -------------------- */
+    "not","only","very","too","quite",
+    "so","then","there","here",
+    "when","where","why","how",
+    "again","once","ever","never",
+    "already","still","often","sometimes","usually",
+
+    /* --------------------
+       Comparatives & Intensifiers
+       -------------------- */
+    "more","most","less","least",
+    "enough","rather","quite",
+
+    /* --------------------
+       Discourse / Filler Words
+       -------------------- */
+    "yes","no","ok","okay",
+    "also","just","even","though",
+    "however","therefore","thus","hence",
+    "otherwise","meanwhile","furthermore",
+    "moreover","nevertheless",
+
+    /* --------------------
+       Time & Frequency
+       -------------------- */
+    "today","yesterday","tomorrow",
+    "now","then","soon","later",
+    "always","never","often","sometimes","usually",
+
+    /* --------------------
+       Question Words
+       -------------------- */
+    "who","whom","whose",
+    "which","what","when","where","why","how",
+
+    /* --------------------
+       Numbers (written)
+       -------------------- */
+    "zero","one","two","three","four","five","six","seven","eight","nine","ten",
+    "first","second","third","fourth","fifth","sixth","seventh","eighth","ninth","tenth",
+
+    /* --------------------
+       Abbreviations & Noise
+       -------------------- */
+    "etc","ie","eg","vs","via","per",
+
+    /* --------------------
+       Web / Modern Noise
+       -------------------- */
+    "http","https","www","com","org","net",
+
+    /* --------------------
+       Generic Nouns (low semantic value)
+       -------------------- */
+    "thing","things","stuff",
+    "something","anything","everything",
+    "someone","anyone","everyone"
+};
+
+/* ============================================================
+   POSitional Index Persistence (Optional Utility)
+   ============================================================ */
+
+void saveIndex(
+    const std::string& filename,
+    const std::unordered_map<
+        std::string,
+        std::unordered_map<int, std::vector<int>>
+    >& positionalIndex
+) {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "Error: Unable to open index file for writing\n";
+        return;
+    }
+
+    for (const auto& [word, docMap] : positionalIndex) {
+        for (const auto& [docID, positions] : docMap) {
+            out << word << " " << docID;
+            for (int pos : positions) {
+                out << " " << pos;
+            }
+            out << '\n';
+        }
+    }
+}
+
+void loadIndex(
+    const std::string& filename,
+    std::unordered_map<
+        std::string,
+        std::unordered_map<int, std::vector<int>>
+    >& positionalIndex
+) {
+    std::ifstream in(filename);
+    if (!in) {
+        std::cerr << "Index file not found. Rebuilding index...\n";
+        return;
+    }
+
+    positionalIndex.clear();
+
+    std::string word;
+    int docID, pos;
+
+    while (in >> word >> docID) {
+        while (in.peek() == ' ') {
+            in >> pos;
+            positionalIndex[word][docID].push_back(pos);
+        }
+    }
+}
+
+const std::string INDEX_FILE = "positional_index.txt";
+
+/* ============================================================
+   PHRASE MATCHING (Two-Word Positional Merge)
+   ============================================================ */
+
+bool phraseMatchTwoWords(
+    const std::vector<int>& p1,
+    const std::vector<int>& p2
+) {
+    size_t i = 0, j = 0;
+
+    while (i < p1.size() && j < p2.size()) {
+        if (p2[j] == p1[i] + 1) {
+            return true;  // exact adjacency match
+        } else if (p2[j] > p1[i]) {
+            ++i;
+        } else {
+            ++j;
+        }
+    }
+    return false;
+}
+
+/* ============================================================
+   MULTITHREADING INFRASTRUCTURE
+   ============================================================ */
+
+// Protects global index during merge
+std::mutex indexMutex;
+
+/*
+NOTE ON FALSE SHARING:
+- Multiple threads may update adjacent memory (docLength entries).
+- This can cause cache-line contention ("false sharing").
+- Not optimized here because updates are coarse-grained.
+- Would require padding or per-thread buffers to eliminate fully.
+*/
+
+/* ============================================================
+   DOCUMENT INDEXING WORKER (THREAD-SAFE)
+   ============================================================ */
+
+void indexDocuments(
+    int start,
+    int end,
+    const std::vector<Document>& documents,
+    std::unordered_map<
+        std::string,
+        std::unordered_map<int, std::vector<int>>
+    >& globalIndex,
+    std::unordered_map<int, int>& globalDocLength
+) {
+    /*
+     Strategy:
+     - Each thread builds its own local index (NO locks).
+     - After processing its document range, it merges once
+       into the shared global index (single lock).
+     - This drastically reduces lock contention.
+    */
+
+    std::unordered_map<
+        std::string,
+        std::unordered_map<int, std::vector<int>>
+    > localIndex;
+
+    std::unordered_map<int, int> localDocLength;
+
+    for (int docID = start; docID < end; ++docID) {
+
+        const std::string& content = documents[docID].content;
+        if (content.empty()) continue;
+
+        auto tokens = tokenize(content);
+        int position = 0;
+
+        for (const auto& token : tokens) {
+            if (stopWords.count(token)) continue;
+
+            localIndex[token][docID].push_back(position);
+            localDocLength[docID]++;
+            position++;
+        }
+    }
+
+    // ---- Merge Phase (single critical section) ----
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+
+        for (auto& [word, docMap] : localIndex) {
+            for (auto& [docID, positions] : docMap) {
+                auto& globalPositions = globalIndex[word][docID];
+                globalPositions.insert(
+                    globalPositions.end(),
+                    positions.begin(),
+                    positions.end()
+                );
+            }
+        }
+
+        for (auto& [docID, len] : localDocLength) {
+            globalDocLength[docID] += len;
+        }
+    }
+}
+
+
+
+/* ============================================================
+   DOCUMENT LOADING (SINGLE-THREADED I/O)
+   ============================================================ */
+
+std::vector<Document> loadDocuments(const std::string& dataDir) {
+    std::vector<Document> documents;
+    int docID = 0;
+
+    for (const auto& entry : std::filesystem::directory_iterator(dataDir)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+
+        std::ifstream file(entry.path());
+        if (!file.is_open()) {
+            continue;
+        }
+
+        std::string content(
+            (std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>()
+        );
+
+        documents.push_back({
+            docID,
+            entry.path().string(),
+            std::move(content)
+        });
+
+        docID++;
+    }
+
+    return documents;
+}
+
+/* ============================================================
+   PARALLEL INDEX BUILD (PER-DOCUMENT CHUNKS)
+   ============================================================ */
+
+void buildIndexParallel(
+    const std::vector<Document>& documents,
+    unsigned int numThreads,
+    PositionalIndex& positionalIndex,
+    std::unordered_map<int, int>& docLength
+) {
+    positionalIndex.clear();
+    docLength.clear();
+    for (size_t i = 0; i < documents.size(); i++) {
+        docLength[i] = 0;
+    }
+
+    if (numThreads == 0) numThreads = 1;
+
+    int N = static_cast<int>(documents.size());
+    int chunkSize = (N + numThreads - 1) / numThreads;
+
+    std::vector<std::thread> threads;
+
+    for (unsigned int i = 0; i < numThreads; i++) {
+        int start = i * chunkSize;
+        int end   = std::min(start + chunkSize, N);
+
+        if (start >= end) break;
+
+        threads.emplace_back(
+            indexDocuments,
+            start,
+            end,
+            std::cref(documents),
+            std::ref(positionalIndex),
+            std::ref(docLength)
+        );
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef INDEXER_H
+#define INDEXER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+// Positional inverted index
+// word -> { docID -> [pos1, pos2, ...] }
+using PositionalIndex = std::unordered_map<
+    std::string,
+    std::unordered_map<int, std::vector<int>>
+>;
+
+// ============================================================
+// Document representation
+// ============================================================
+//
+// Represents a single document in the corpus.
+//
+// - id      : unique numeric document identifier
+// - path    : file path on disk
+// - content : full text of the document
+//
+// Documents are loaded once (single-threaded I/O) and then
+// indexed in parallel using per-document parallelism.
+//
+struct Document {
+    int id;
+    std::string path;
+    std::string content;
+};
+
+// Lowercases text and splits it on non-alphanumeric characters.
+// Tokens shorter than 2 characters are dropped.
+std::vector<std::string> tokenize(const std::string& text);
+
+// Stop words removed from both documents and queries
+extern std::unordered_set<std::string> stopWords;
+
+// Text index persistence (one "word docID pos..." line per posting)
+extern const std::string INDEX_FILE;
+
+void saveIndex(
+    const std::string& filename,
+    const PositionalIndex& positionalIndex
+);
+
+void loadIndex(
+    const std::string& filename,
+    PositionalIndex& positionalIndex
+);
+
+// True if some position in p2 directly follows a position in p1
+bool phraseMatchTwoWords(
+    const std::vector<int>& p1,
+    const std::vector<int>& p2
+);
+
+// Indexes documents [start, end) into a thread-local index and
+// merges it into globalIndex / globalDocLength under a single lock.
+void indexDocuments(
+    int start,
+    int end,
+    const std::vector<Document>& documents,
+    PositionalIndex& globalIndex,
+    std::unordered_map<int, int>& globalDocLength
+);
+
+// Reads every regular file in dataDir (single-threaded I/O).
+// DocIDs follow directory iteration order.
+std::vector<Document> loadDocuments(const std::string& dataDir);
+
+// Splits documents into contiguous chunks, one indexDocuments()
+// worker per chunk. Resets the index and docLength first.
+void buildIndexParallel(
+    const std::vector<Document>& documents,
+    unsigned int numThreads,
+    PositionalIndex& positionalIndex,
+    std::unordered_map<int, int>& docLength
+);
+
+#endif
@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 #include <cctype>
+#include <algorithm>
 
 // Containers
 #include <unordered_set>
@@ -16,421 +17,694 @@
 
 // Filesystem support
 #include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
 
 // Timing and concurrency
 #include <chrono>
+#include <functional>
 #include <mutex>
 #include <thread>
 
 // Project headers
+#include "indexer.h"
+#include "memory.h"
 #include "ranker.h"
+#include "bench.h"
+#include "biword.h"
+#include "pruning.h"
+#include "query_shapes.h"
+#include "scheduler.h"
+#include "reorder.h"
+#include "segment.h"
+#include "snapshot.h"
+#include "tiered_index.h"
 
 namespace fs = std::filesystem;
 
-// ============================================================
-// Document representation
-// ============================================================
-//
-// Represents a single document in the corpus.
-//
-// - id      : unique numeric document identifier
-// - path    : file path on disk
-// - content : full text of the document
-//
-// Documents are loaded once (single-threaded I/O) and then
-// indexed in parallel using per-document parallelism.
-//
-struct Document {
-    int id;
-    std::string path;
-    std::string content;
-};
+/* ============================================================
+   SYNTHETIC CORPUS GENERATOR
+   ============================================================
+   Slices a source text (e.g. data/corpus.txt) into fixed-size
+   documents until targetBytes have been written. Each document
+   starts at a different line offset so documents are not exact
+   copies, while the term distribution stays realistic.
+   ============================================================ */
 
+std::size_t generateSyntheticCorpus(
+    const fs::path& source,
+    const fs::path& outDir,
+    std::size_t targetBytes
+) {
+    const std::size_t DOC_BYTES = 64 * 1024;
 
-// ============================================================
-// Tokenizer
-// ============================================================
-//
-// Purpose:
-// - Normalizes text for indexing and querying
-// - Produces consistent tokens across documents and queries
-//
-// Rules:
-// - Converts all characters to lowercase
-// - Treats any non-alphanumeric character as a delimiter
-// - Splits on whitespace and punctuation
-// - Ignores tokens with length < 2
-//
-// Notes:
-// - Used for both document indexing and query processing
-// - Token *positions* are tracked by the caller (important for
-//   positional inverted index and phrase queries)
-// - This function itself is stateless and thread-safe
-//
-std::vector<std::string> tokenize(const std::string& text) {
-    std::vector<std::string> tokens;
-    std::string current;
-    current.reserve(16);  // Small optimization to reduce reallocations
-
-    for (unsigned char ch : text) {
-        char c = static_cast<char>(std::tolower(ch));
-
-        if (std::isalnum(c)) {
-            current.push_back(c);
-        } else {
-            // Delimiter encountered: flush current token
-            if (current.size() >= 2) {
-                tokens.push_back(current);
-            }
-            current.clear();
-        }
+    std::ifstream in(source);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty()) lines.push_back(line);
+    }
+    if (lines.empty()) {
+        std::cerr << "Source corpus is empty: " << source << "\n";
+        return 0;
     }
 
-    // Flush final token if present
-    if (current.size() >= 2) {
-        tokens.push_back(current);
+    fs::create_directories(outDir);
+
+    std::size_t written = 0;
+    std::size_t docs = 0;
+    std::size_t cursor = 0;
+
+    while (written < targetBytes) {
+        std::ofstream out(outDir / ("doc" + std::to_string(docs) + ".txt"));
+        std::size_t docBytes = 0;
+
+        cursor = (cursor + 97) % lines.size();
+        for (std::size_t i = cursor; docBytes < DOC_BYTES; i = (i + 1) % lines.size()) {
+            out << lines[i] << '\n';
+            docBytes += lines[i].size() + 1;
+        }
+
+        written += docBytes;
+        docs++;
     }
 
-    return tokens;
+    return docs;
 }
 
 
+/* ============================================================
+   WARM STARTUP HELPERS
+   ============================================================ */
+
+// Queries read from the end of a query log for prefetching
+const std::size_t PREFETCH_LOG_QUERIES = 1000;
+
+// Last maxQueries non-empty lines of a query log
+std::vector<std::string> readRecentQueries(const std::string& filename, std::size_t maxQueries) {
+    std::ifstream in(filename);
+    std::vector<std::string> queries;
+    std::string line;
+
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        if (line.size() >= 2 && line.front() == '"' && line.back() == '"') {
+            line = line.substr(1, line.size() - 2);
+        }
+        queries.push_back(line);
+    }
+    if (queries.size() > maxQueries) {
+        queries.erase(queries.begin(), queries.end() - maxQueries);
+    }
+    return queries;
+}
+
+// Evicts a file's clean pages from the page cache, so a warm
+// start can be measured as if after a reboot (Linux only)
+void dropFromPageCache(const std::string& filename) {
+#ifdef POSIX_FADV_DONTNEED
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+#else
+    (void)filename;
+#endif
+}
 
-/// STEP 4: Stop word list
-// ---------------------
-// Purpose:
-// - Removes high-frequency, low-information words from indexing and queries
-// - Improves ranking quality and reduces index size
-//
-// Notes:
-// - Stop words are applied consistently during:
-//   1) Document indexing
-//   2) Query processing
-// - Phrase queries preserve token order *after* stop-word removal
-
-std::unordered_set<std::string> stopWords = {
-
-    /* --------------------
-       Articles
-       -------------------- */
-    "a", "an", "the",
-
-    /* --------------------
-       Pronouns
-       -------------------- */
-    "i","me","my","mine","myself",
-    "you","your","yours","yourself","yourselves",
-    "he","him","his","himself",
-    "she","her","hers","herself",
-    "it","its","itself",
-    "we","us","our","ours","ourselves",
-    "they","them","their","theirs","themselves",
-    "one","ones","someone","anyone","everyone","nobody","nothing","something",
-
-    /* --------------------
-       Auxiliary & Modal Verbs
-       -------------------- */
-    "am","is","are","was","were",
-    "be","been","being",
-    "have","has","had","having",
-    "do","does","did","doing",
-    "will","would","shall","should",
-    "can","could","may","might","must","ought",
-
-    /* --------------------
-       Common Verb Noise
-       -------------------- */
-    "say","says","said","saying",
-    "get","gets","got","getting",
-    "make","makes","made","making",
-    "go","goes","went","going",
-    "know","knows","knew","knowing",
-    "think","thinks","thought","thinking",
-    "see","sees","saw","seeing",
-    "come","comes","came","coming",
-    "take","takes","took","taking",
-    "use","uses","used","using",
-    "find","finds","found","finding",
-    "give","gives","gave","giving",
-    "tell","tells","told","telling",
-    "work","works","worked","working",
-    "seem","seems","seemed","seeming",
-    "try","tries","tried","trying",
-    "leave","leaves","left","leaving",
-    "call","calls","called","calling",
-    "start","starts","started","starting",
-    "end","ends","ended","ending",
-    "show","shows","showed","showing",
-    "play","plays","played","playing",
-    "run","runs","ran","running",
-    "move","moves","moved","moving",
-
-    /* --------------------
-       Conjunctions
-       -------------------- */
-    "and","or","but","if","while","because","as",
-    "until","unless","although","though","whereas",
-    "whether","nor","yet","so",
-
-    /* --------------------
-       Prepositions
-       -------------------- */
-    "of","to","in","on","at","by","for","with",
-    "about","against","between","into","through",
-    "during","before","after","above","below",
-    "from","up","down","out","off","over","under",
-    "within","without","across","behind","beyond",
-    "near","along","among","around","toward","towards",
-
-    /* --------------------
-       Determiners & Quantifiers
-       -------------------- */
-    "this","that","these","those",
-    "each","every","either","neither",
-    "some","any","no","none","all","both",
-    "many","much","few","several","most","least",
-    "such","same","other","another",
-
-    /* --------------------
-       Adverbs
-       -------------------- */
-    "not","only","very","too","quite",
-    "so","then","there","here",
-    "when","where","why","how",
-    "again","once","ever","never",
-    "already","still","often","sometimes","usually",
-
-    /* --------------------
-       Comparatives & Intensifiers
-       -------------------- */
-    "more","most","less","least",
-    "enough","rather","quite",
-
-    /* --------------------
-       Discourse / Filler Words
-       -------------------- */
-    "yes","no","ok","okay",
-    "also","just","even","though",
-    "however","therefore","thus","hence",
-    "otherwise","meanwhile","furthermore",
-    "moreover","nevertheless",
-
-    /* --------------------
-       Time & Frequency
-       -------------------- */
-    "today","yesterday","tomorrow",
-    "now","then","soon","later",
-    "always","never","often","sometimes","usually",
-
-    /* --------------------
-       Question Words
-       -------------------- */
-    "who","whom","whose",
-    "which","what","when","where","why","how",
-
-    /* --------------------
-       Numbers (written)
-       -------------------- */
-    "zero","one","two","three","four","five","six","seven","eight","nine","ten",
-    "first","second","third","fourth","fifth","sixth","seventh","eighth","ninth","tenth",
-
-    /* --------------------
-       Abbreviations & Noise
-       -------------------- */
-    "etc","ie","eg","vs","via","per",
-
-    /* --------------------
-       Web / Modern Noise
-       -------------------- */
-    "http","https","www","com","org","net",
-
-    /* --------------------
-       Generic Nouns (low semantic value)
-       -------------------- */
-    "thing","things","stuff",
-    "something","anything","everything",
-    "someone","anyone","everyone"
-};
 
 /* ============================================================
-   POSitional Index Persistence (Optional Utility)
+   QUERY PROCESSING
+   ============================================================
+   Runs one query against a single immutable snapshot. The
+   caller keeps the snapshot alive for the whole query, so a
+   concurrent rebuild never changes the index underneath it.
+   Ranked queries stop at the deadline / posting budget (0 means
+   unlimited) and report that their results are partial.
    ============================================================ */
 
-void saveIndex(
-    const std::string& filename,
-    const std::unordered_map<
-        std::string,
-        std::unordered_map<int, std::vector<int>>
-    >& positionalIndex
+void processQuery(
+    const IndexSnapshot& snapshot,
+    QueryScheduler& scheduler,
+    std::string query,
+    int deadlineMs,
+    std::size_t maxPostings
 ) {
-    std::ofstream out(filename);
-    if (!out) {
-        std::cerr << "Error: Unable to open index file for writing\n";
-        return;
+
+    /* -------------------------------
+       START QUERY TIMER
+       ------------------------------- */
+    auto queryStart = std::chrono::high_resolution_clock::now();
+
+    /* ===============================
+       DETECT PHRASE QUERY
+       =============================== */
+    bool isPhraseQuery = false;
+
+    if (query.size() >= 2 && query.front() == '"' && query.back() == '"') {
+        isPhraseQuery = true;
+        query = query.substr(1, query.size() - 2);  // strip quotes
     }
 
-    for (const auto& [word, docMap] : positionalIndex) {
-        for (const auto& [docID, positions] : docMap) {
-            out << word << " " << docID;
-            for (int pos : positions) {
-                out << " " << pos;
-            }
-            out << '\n';
+    // Tokenize AFTER stripping quotes
+    auto queryTokens = tokenize(query);
+
+    /* ===============================
+       PRESERVE ORDER FOR PHRASES
+       =============================== */
+    std::vector<std::string> orderedQueryTokens;
+    for (const auto& token : queryTokens) {
+        if (!stopWords.count(token)) {
+            orderedQueryTokens.push_back(token);
         }
     }
-}
 
-void loadIndex(
-    const std::string& filename,
-    std::unordered_map<
-        std::string,
-        std::unordered_map<int, std::vector<int>>
-    >& positionalIndex
-) {
-    std::ifstream in(filename);
-    if (!in) {
-        std::cerr << "Index file not found. Rebuilding index...\n";
+    if (orderedQueryTokens.empty()) {
+        std::cout << "No valid query terms after filtering stop words.\n";
         return;
     }
 
-    positionalIndex.clear();
+    /* ===============================
+       PHRASE QUERY PATH
+       =============================== */
+    if (isPhraseQuery && orderedQueryTokens.size() >= 2) {
+
+        // Segment-backed snapshots (warm-start bootstrap, --tiered) hold no positions
+        if (snapshot.positionalIndex.empty() && snapshot.tiered) {
+            std::cout << "Phrase queries need the in-memory index; this snapshot serves "
+                         "ranked queries from the mapped segment only.\n";
+            return;
+        }
 
-    std::string word;
-    int docID, pos;
+        std::vector<int> matchingDocs = matchPhraseWithBiwords(
+            snapshot.positionalIndex,
+            snapshot.biwordIndex,
+            orderedQueryTokens
+        );
 
-    while (in >> word >> docID) {
-        while (in.peek() == ' ') {
-            in >> pos;
-            positionalIndex[word][docID].push_back(pos);
+        if (matchingDocs.empty()) {
+            std::cout << "No documents match the phrase.\n";
+        } else {
+            std::cout << "Phrase match found in:\n";
+            for (int docID : matchingDocs) {
+                std::cout << "- " << snapshot.docIdToName.at(docID) << "\n";
+            }
         }
+
     }
+    /* ===============================
+       RANKED QUERY PATH (TF-IDF)
+       =============================== */
+    else {
+
+        // Queries are short: a linear scan beats hashing into a set
+        std::vector<std::string> queryTokenVector;
+        for (const auto& token : orderedQueryTokens) {
+            if (std::find(queryTokenVector.begin(), queryTokenVector.end(), token) ==
+                queryTokenVector.end()) {
+                queryTokenVector.push_back(token);
+            }
+        }
+
+        std::cout << "Enter K (press Enter for default 5): ";
+        std::string kInput;
+        std::getline(std::cin, kInput);
+
+        int K = 5;
+        if (!kInput.empty()) {
+            try {
+                K = std::stoi(kInput);
+                if (K <= 0) K = 5;
+            } catch (...) {
+                K = 5;
+            }
+        }
+
+        // Deadline starts after the K prompt: typing time is not query time
+        QueryBudget budget;
+        if (deadlineMs > 0) {
+            budget.deadline = std::chrono::steady_clock::now() +
+                              std::chrono::milliseconds(deadlineMs);
+        }
+        if (maxPostings > 0) budget.maxPostings = maxPostings;
+
+        auto rankedResults = scheduler.rank(
+            snapshot,
+            queryTokenVector,
+            K,
+            &budget
+        );
+
+        if (budget.exhausted) {
+            std::cout << "(partial results: budget exhausted after "
+                      << budget.postingsScored.load() << " postings)\n";
+        }
+
+        if (rankedResults.empty()) {
+            std::cout << "No query terms found in the index.\n";
+        } else {
+            int rank = 1;
+            for (const auto& p : rankedResults) {
+                std::cout << "Rank " << rank << ": "
+                          << snapshot.docIdToName.at(p.first)
+                          << " (score: " << p.second << ")\n";
+                rank++;
+            }
+        }
+    }
+
+    /* -------------------------------
+       END QUERY TIMER
+       ------------------------------- */
+    auto queryEnd = std::chrono::high_resolution_clock::now();
+    long long queryTimeMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            queryEnd - queryStart
+        ).count();
+
+    std::cout << "Query latency: " << queryTimeMs << " ms\n";
 }
 
-const std::string INDEX_FILE = "positional_index.txt";
 
 /* ============================================================
-   PHRASE MATCHING (Two-Word Positional Merge)
+   INTERACTIVE QUERY LOOP
+   ============================================================
+   Commands:
+   - :reload         rebuild from the data directory in the background
+   - :load <segment> load a segment + doc table in the background
+   Queries keep running on the current snapshot meanwhile.
    ============================================================ */
 
-bool phraseMatchTwoWords(
-    const std::vector<int>& p1,
-    const std::vector<int>& p2
+void runQueryLoop(
+    SnapshotManager& snapshots,
+    QueryScheduler& scheduler,
+    const SnapshotManager::Builder& reload,
+    const std::function<SnapshotManager::Builder(const std::string&)>& loadSegmentBuilder,
+    const QueryBenchOptions& limits
 ) {
-    size_t i = 0, j = 0;
+    std::string query;
 
-    while (i < p1.size() && j < p2.size()) {
-        if (p2[j] == p1[i] + 1) {
-            return true;  // exact adjacency match
-        } else if (p2[j] > p1[i]) {
-            ++i;
-        } else {
-            ++j;
+    while (true) {
+        std::cout << "\nEnter query: ";
+        if (!std::getline(std::cin, query)) {
+            break;
+        }
+
+        if (query == ":reload" || query.rfind(":load ", 0) == 0) {
+            SnapshotManager::Builder build = reload;
+
+            if (query != ":reload") build = loadSegmentBuilder(query.substr(6));
+
+            if (snapshots.rebuildAsync(std::move(build))) {
+                std::cout << "Rebuilding index in the background...\n";
+            } else {
+                std::cout << "A rebuild is already in progress.\n";
+            }
+            continue;
+        }
+
+        if (query.empty()) {
+            std::cout << "Empty query. Please enter one or more words.\n";
+            continue;
         }
+
+        std::shared_ptr<const IndexSnapshot> snapshot = snapshots.acquire();
+        processQuery(
+            *snapshot, scheduler, query,
+            limits.deadlineMs, limits.maxPostings
+        );
     }
-    return false;
+
+    snapshots.waitForRebuild();
 }
 
-/* ============================================================
-   MULTITHREADING INFRASTRUCTURE
+
+int main(int argc, char* argv[]) {
+// Time-to-first-query is measured from here
+const auto processStart = std::chrono::steady_clock::now();
+
+   /* ============================================================
+   DATASET SETUP
+   ============================================================
+   Usage:
+     search_engine [dataDir]
+     search_engine [dataDir] --stream-build <segment> [--mem-mb N]
+     search_engine --synth <outDir> <sizeMB> [--stream-build ...]
+     search_engine [dataDir] --bench [--queries <file>] [--clients N] [--runs N]
+     search_engine --open <segment> [--prefetch-log <file>] [--bench]
+   Options:
+     --query-threads N   workers for intra-query parallelism
+     --split-postings N  postings per intra-query task (default 16384)
+     --reorder M         docID reassignment: none | path | bp
+     --biwords N         biword index for pairs seen >= N times
+     --prune F           tier-1 index keeping the top F of each posting list
+     --prune-min N       ... but at least N postings per term (default 64)
+     --deadline-ms N     per-query deadline; partial results after it
+     --max-postings N    per-query budget of scored postings
+     --slo-ms N          bench: shed queries whose queue wait exceeds N ms
+     --max-concurrent N  bench: admission slots (default: query threads)
+     --mem-report        bytes per index structure (tracking allocator;
+                         briefly re-allocates the largest structure)
+     --tiered <segment>  serve ranked queries from a mmap'd segment (built if missing)
+     --hot-mb N          RAM budget for decoded hot postings (tiered / --open)
+     --save-segment <s>  write the built index as <s> + <s>.docs for --open
+     --prefetch-log <f>  --open: madvise the postings of the last queries in f
+     --drop-cache        --open: evict the segment from the page cache first
    ============================================================ */
 
-// Protects global index during merge
-std::mutex indexMutex;
+fs::path dataDir = "data/10k";
 
-/*
-NOTE ON FALSE SHARING:
-- Multiple threads may update adjacent memory (docLength entries).
-- This can cause cache-line contention ("false sharing").
-- Not optimized here because updates are coarse-grained.
-- Would require padding or per-thread buffers to eliminate fully.
-*/
+std::string streamSegment;
+std::size_t memBudgetMb = 256;
+fs::path synthDir;
+std::size_t synthMb = 0;
+bool runBench = false;
+std::string benchQueryFile;
+QueryBenchOptions benchOptions;
+unsigned int queryThreads = std::thread::hardware_concurrency();
+std::size_t splitPostings = QueryScheduler::DEFAULT_MIN_POSTINGS_PER_TASK;
+ReorderMethod reorderMethod = ReorderMethod::None;
+int biwordMinFrequency = 0;
+double pruneFraction = 0.0;
+int pruneMinPostings = 64;
+bool memReport = false;
+std::string tieredSegment;
+std::size_t hotMb = 64;
+std::string openSegment;
+std::string saveSegment;
+std::string prefetchLog;
+bool dropCache = false;
+
+for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "--stream-build" && i + 1 < argc) {
+        streamSegment = argv[++i];
+    } else if (arg == "--mem-mb" && i + 1 < argc) {
+        memBudgetMb = std::stoul(argv[++i]);
+    } else if (arg == "--bench") {
+        runBench = true;
+    } else if (arg == "--queries" && i + 1 < argc) {
+        benchQueryFile = argv[++i];
+    } else if (arg == "--runs" && i + 1 < argc) {
+        benchOptions.runsPerQuery = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--clients" && i + 1 < argc) {
+        benchOptions.clients = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--split-postings" && i + 1 < argc) {
+        splitPostings = std::max<std::size_t>(1, std::stoul(argv[++i]));
+    } else if (arg == "--query-threads" && i + 1 < argc) {
+        queryThreads = std::stoul(argv[++i]);
+    } else if (arg == "--deadline-ms" && i + 1 < argc) {
+        benchOptions.deadlineMs = std::max(0, std::stoi(argv[++i]));
+    } else if (arg == "--max-postings" && i + 1 < argc) {
+        benchOptions.maxPostings = std::stoul(argv[++i]);
+    } else if (arg == "--slo-ms" && i + 1 < argc) {
+        benchOptions.sloMs = std::max(0, std::stoi(argv[++i]));
+    } else if (arg == "--max-concurrent" && i + 1 < argc) {
+        benchOptions.maxConcurrent = std::stoul(argv[++i]);
+    } else if (arg == "--mem-report") {
+        memReport = true;
+    } else if (arg == "--tiered" && i + 1 < argc) {
+        tieredSegment = argv[++i];
+    } else if (arg == "--hot-mb" && i + 1 < argc) {
+        hotMb = std::stoul(argv[++i]);
+    } else if (arg == "--open" && i + 1 < argc) {
+        openSegment = argv[++i];
+    } else if (arg == "--save-segment" && i + 1 < argc) {
+        saveSegment = argv[++i];
+    } else if (arg == "--prefetch-log" && i + 1 < argc) {
+        prefetchLog = argv[++i];
+    } else if (arg == "--drop-cache") {
+        dropCache = true;
+    } else if (arg == "--biwords" && i + 1 < argc) {
+        biwordMinFrequency = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--prune" && i + 1 < argc) {
+        pruneFraction = std::stod(argv[++i]);
+    } else if (arg == "--prune-min" && i + 1 < argc) {
+        pruneMinPostings = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--reorder" && i + 1 < argc) {
+        if (!parseReorderMethod(argv[++i], reorderMethod)) {
+            std::cerr << "Unknown reorder method: " << argv[i] << "\n";
+            return 1;
+        }
+    } else if (arg == "--synth" && i + 2 < argc) {
+        synthDir = argv[++i];
+        synthMb = std::stoul(argv[++i]);
+    } else {
+        dataDir = arg;
+    }
+}
+
+/* ------------------------------------------------------------
+   OPTIONAL: GENERATE A SYNTHETIC CORPUS
+   ------------------------------------------------------------ */
+if (!synthDir.empty()) {
+    std::size_t docs = generateSyntheticCorpus(
+        "data/corpus.txt", synthDir, synthMb << 20
+    );
+    std::cout << "Generated " << docs << " documents ("
+              << synthMb << " MB) in " << synthDir << "\n";
+    dataDir = synthDir;
+
+    if (streamSegment.empty()) return 0;
+}
+
+// A warm start or an existing tiered segment needs no corpus;
+// dataDir is used by :reload
+const bool servesSavedSegment = !openSegment.empty() ||
+    (!tieredSegment.empty() && !runBench && fs::exists(tieredSegment));
+if (!servesSavedSegment && (!fs::exists(dataDir) || !fs::is_directory(dataDir))) {
+    std::cerr << "Data directory not found: " << dataDir << "\n";
+    return 1;
+}
+
+/* ------------------------------------------------------------
+   OPTIONAL: STREAMING BUILD (BOUNDED MEMORY, EXTERNAL MERGE)
+   ------------------------------------------------------------
+   - Never holds the corpus or the full index in memory
+   - Produces <segment> and <segment>.docs, then exits
+   ------------------------------------------------------------ */
+if (!streamSegment.empty()) {
+    StreamBuildOptions options;
+    options.memoryBudgetBytes = memBudgetMb << 20;
+
+    StreamBuildStats stats;
+    if (!buildSegmentStreaming(dataDir.string(), streamSegment, options, stats)) {
+        std::cerr << "Streaming build failed\n";
+        return 1;
+    }
+
+    double seconds = stats.elapsedMs / 1000.0;
+    double mb = stats.bytesRead / (1024.0 * 1024.0);
+
+    std::cout << "Streaming build: " << stats.docs << " docs, "
+              << mb << " MB, " << stats.tokens << " tokens\n";
+    std::cout << "Sorted runs: " << stats.runs
+              << " (budget " << memBudgetMb << " MB)\n";
+    std::cout << "Segment: " << stats.terms << " terms, "
+              << stats.segmentBytes / 1024 << " KB\n";
+    std::cout << "Build time: " << stats.elapsedMs << " ms\n";
+    if (seconds > 0) {
+        std::cout << "Throughput: " << mb / seconds << " MB/s, "
+                  << stats.docs / seconds << " docs/s\n";
+    }
+    std::cout << "Peak RSS: " << stats.peakRssKb / 1024 << " MB\n";
+    return 0;
+}
 
 /* ============================================================
-   DOCUMENT INDEXING WORKER (THREAD-SAFE)
+   SNAPSHOTS AND QUERY WORKERS
    ============================================================ */
 
-void indexDocuments(
-    int start,
-    int end,
-    const std::vector<Document>& documents,
-    std::unordered_map<
-        std::string,
-        std::unordered_map<int, std::vector<int>>
-    >& globalIndex,
-    std::unordered_map<int, int>& globalDocLength
-) {
-    /*
-     Strategy:
-     - Each thread builds its own local index (NO locks).
-     - After processing its document range, it merges once
-       into the shared global index (single lock).
-     - This drastically reduces lock contention.
-    */
+// Decide number of worker threads
+unsigned int numThreads = std::thread::hardware_concurrency();
+if (numThreads == 0) {
+    numThreads = 4;  // Safe fallback
+}
 
-    std::unordered_map<
-        std::string,
-        std::unordered_map<int, std::vector<int>>
-    > localIndex;
+SnapshotManager snapshots;
 
-    std::unordered_map<int, int> localDocLength;
+// Query workers, pinned to cores; snapshots are split into one
+// docID-range partition per worker
+QueryScheduler scheduler(queryThreads == 0 ? 4 : queryThreads, splitPostings);
 
-    for (int docID = start; docID < end; ++docID) {
+// Derived structures every snapshot gets before it is published
+auto prepareSnapshot = [&scheduler, biwordMinFrequency, pruneFraction, pruneMinPostings](
+    IndexSnapshot& snapshot
+) {
+    partitionSnapshot(snapshot, scheduler.pool());
+
+    if (biwordMinFrequency > 0) {
+        snapshot.biwordIndex = buildBiwordIndex(
+            snapshot.positionalIndex,
+            snapshot.docLength,
+            biwordMinFrequency
+        );
+    }
 
-        const std::string& content = documents[docID].content;
-        if (content.empty()) continue;
+    if (pruneFraction > 0.0) {
+        snapshot.prunedIndex = buildPrunedIndex(
+            snapshot.positionalIndex,
+            snapshot.docLength,
+            pruneFraction,
+            pruneMinPostings
+        );
+    }
+};
 
-        auto tokens = tokenize(content);
-        int position = 0;
+// Full rebuild from dataDir (":reload")
+SnapshotManager::Builder reload = [dataDir, numThreads, reorderMethod, &prepareSnapshot]() {
+    if (!fs::is_directory(dataDir)) {
+        std::cerr << "Data directory not found: " << dataDir << "\n";
+        return std::shared_ptr<IndexSnapshot>();
+    }
+    auto next = buildSnapshotFromDirectory(dataDir.string(), numThreads, reorderMethod);
+    prepareSnapshot(*next);
+    return next;
+};
 
-        for (const auto& token : tokens) {
-            if (stopWords.count(token)) continue;
+// Full load of a saved segment (":load <segment>")
+auto loadSegmentBuilder = [numThreads, &prepareSnapshot](const std::string& segment) {
+    return SnapshotManager::Builder([segment, numThreads, &prepareSnapshot]() {
+        auto next = loadSnapshotFromSegment(segment, numThreads);
+        if (next) prepareSnapshot(*next);
+        return next;
+    });
+};
 
-            localIndex[token][docID].push_back(position);
-            localDocLength[docID]++;
-            position++;
-        }
+/* ============================================================
+   OPTIONAL: FAST WARM STARTUP FROM A SAVED SEGMENT
+   ============================================================
+   - No corpus walk and no build benchmark
+   - Publishes a bootstrap snapshot right away: the doc table
+     plus the segment mmap'd as a TieredIndex (ranked queries)
+   - Decodes the full index in parallel in the background and
+     swaps it in when ready
+   ============================================================ */
+if (!openSegment.empty()) {
+    if (dropCache) {
+        dropFromPageCache(openSegment);
+        dropFromPageCache(openSegment + ".docs");
     }
 
-    // ---- Merge Phase (single critical section) ----
-    {
-        std::lock_guard<std::mutex> lock(indexMutex);
-
-        for (auto& [word, docMap] : localIndex) {
-            for (auto& [docID, positions] : docMap) {
-                auto& globalPositions = globalIndex[word][docID];
-                globalPositions.insert(
-                    globalPositions.end(),
-                    positions.begin(),
-                    positions.end()
-                );
+    std::shared_ptr<IndexSnapshot> bootstrap = openTieredSnapshot(openSegment, hotMb << 20);
+    if (!bootstrap) return 1;
+
+    /* --------------------------------------------------
+       QUERY-LOG PREFETCH
+       -------------------------------------------------- */
+    std::size_t prefetchedBytes = 0;
+    std::size_t prefetchedTerms = 0;
+
+    if (!prefetchLog.empty()) {
+        std::vector<std::string> recent = readRecentQueries(prefetchLog, PREFETCH_LOG_QUERIES);
+        std::unordered_set<std::string> seen;
+        std::vector<std::string> terms;
+
+        for (const auto& q : recent) {
+            for (const auto& token : tokenize(q)) {
+                if (!stopWords.count(token) && seen.insert(token).second) terms.push_back(token);
             }
         }
+        prefetchedTerms = terms.size();
+        prefetchedBytes = bootstrap->tiered->prefetch(terms);
+    }
 
-        for (auto& [docID, len] : localDocLength) {
-            globalDocLength[docID] += len;
-        }
+    std::size_t mappedTerms = bootstrap->tiered->termCount();
+    snapshots.publish(std::move(bootstrap));
+
+    std::cout << "[startup] ready for queries after "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - processStart).count()
+              << " ms (" << mappedTerms << " terms mapped";
+    if (!prefetchLog.empty()) {
+        std::cout << ", prefetched " << prefetchedTerms << " terms / "
+                  << prefetchedBytes / 1024 << " KB";
     }
-}
+    std::cout << ")\n";
 
+    snapshots.rebuildAsync(loadSegmentBuilder(openSegment));
 
+    if (runBench) {
+        runWarmStartBenchmark(
+            snapshots, scheduler, loadBenchQueries(benchQueryFile),
+            benchOptions, processStart
+        );
+        snapshots.waitForRebuild();
+        return 0;
+    }
 
-int main() {
-   /* ============================================================
-   DATASET SETUP
-   ============================================================ */
+    runQueryLoop(snapshots, scheduler, reload, loadSegmentBuilder, benchOptions);
+    return 0;
+}
 
-fs::path dataDir = "data/10k";
+/* ============================================================
+   OPTIONAL: MEMORY-BUDGETED SERVING (--tiered without --bench)
+   ============================================================
+   - Ranked queries are served from the mmap'd segment through a
+     TieredIndex; only decoded hot postings (--hot-mb) stay in RAM
+   - The segment (+ .docs) is built from dataDir when missing;
+     :reload rebuilds it and :load maps another segment
+   - Phrase queries need the in-memory index and are refused
+   ============================================================ */
+if (!tieredSegment.empty() && !runBench) {
+    const std::size_t hotBytes = hotMb << 20;
+
+    // Written under a temporary name: the mapped segment is replaced, never rewritten
+    SnapshotManager::Builder buildTiered = [dataDir, numThreads, reorderMethod, tieredSegment, hotBytes]() {
+        if (!fs::is_directory(dataDir)) {
+            std::cerr << "Data directory not found: " << dataDir << "\n";
+            return std::shared_ptr<IndexSnapshot>();
+        }
+        auto full = buildSnapshotFromDirectory(dataDir.string(), numThreads, reorderMethod);
 
-if (!fs::exists(dataDir) || !fs::is_directory(dataDir)) {
-    std::cerr << "Data directory not found: " << dataDir << "\n";
-    return 1;
+        const std::string tmp = tieredSegment + ".tmp";
+        if (!writeSegment(tmp, full->positionalIndex) ||
+            !writeDocTable(tmp + ".docs", full->docIdToName, full->docLength)) {
+            std::cerr << "Error: Unable to write " << tmp << "\n";
+            return std::shared_ptr<IndexSnapshot>();
+        }
+        full.reset();  // only the mapped segment is kept
+
+        std::error_code ec;
+        fs::rename(tmp + ".docs", tieredSegment + ".docs", ec);
+        if (!ec) fs::rename(tmp, tieredSegment, ec);
+        if (ec) {
+            std::cerr << "Error: Unable to replace " << tieredSegment << ": " << ec.message() << "\n";
+            return std::shared_ptr<IndexSnapshot>();
+        }
+        return openTieredSnapshot(tieredSegment, hotBytes);
+    };
+
+    auto mapTiered = [hotBytes](const std::string& segment) {
+        return SnapshotManager::Builder([segment, hotBytes]() {
+            return openTieredSnapshot(segment, hotBytes);
+        });
+    };
+
+    std::shared_ptr<IndexSnapshot> served =
+        fs::exists(tieredSegment) && fs::exists(tieredSegment + ".docs")
+            ? openTieredSnapshot(tieredSegment, hotBytes)
+            : buildTiered();
+    if (!served) return 1;
+
+    std::size_t mappedTerms = served->tiered->termCount();
+    snapshots.publish(std::move(served));
+
+    std::cout << "[startup] ready for queries after "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - processStart).count()
+              << " ms (" << mappedTerms << " terms mapped from " << tieredSegment
+              << ", hot cache " << hotMb << " MB)\n";
+
+    runQueryLoop(snapshots, scheduler, buildTiered, mapTiered, benchOptions);
+    return 0;
 }
 
 // -------------------------------
 // Document storage
 // -------------------------------
-int docID = 0;
-
 // All documents loaded into memory (read-only after load)
 std::vector<Document> documents;
 
@@ -440,10 +714,7 @@ std::unordered_map<int, int> docLength;
 
 // Positional inverted index
 // word -> { docID -> [pos1, pos2, ...] }
-std::unordered_map<
-    std::string,
-    std::unordered_map<int, std::vector<int>>
-> positionalIndex;
+PositionalIndex positionalIndex;
 
 // Map document ID to file path (used for output)
 std::unordered_map<int, std::string> docIdToName;
@@ -467,12 +738,6 @@ std::unordered_map<int, std::string> docIdToName;
    - Leads to severe contention and poor scalability.
    ============================================================ */
 
-// Decide number of worker threads
-unsigned int numThreads = std::thread::hardware_concurrency();
-if (numThreads == 0) {
-    numThreads = 4;  // Safe fallback
-}
-
 std::cout << "Using " << numThreads << " threads for indexing\n";
 
 
@@ -483,31 +748,11 @@ std::cout << "Using " << numThreads << " threads for indexing\n";
    - Disk access does not scale well with threads
    - Keeps indexing phase purely CPU-bound
    ------------------------------------------------------------ */
-for (const auto& entry : fs::directory_iterator(dataDir)) {
-    if (!entry.is_regular_file()) {
-        continue;
-    }
-
-    std::ifstream file(entry.path());
-    if (!file.is_open()) {
-        continue;
-    }
+documents = loadDocuments(dataDir.string());
 
-    std::string content(
-        (std::istreambuf_iterator<char>(file)),
-        std::istreambuf_iterator<char>()
-    );
-
-    documents.push_back({
-        docID,
-        entry.path().string(),
-        content
-    });
-
-    docIdToName[docID] = entry.path().string();
-    docLength[docID] = 0;   // initialized, filled during indexing
-
-    docID++;
+for (const auto& doc : documents) {
+    docIdToName[doc.id] = doc.path;
+    docLength[doc.id] = 0;   // initialized, filled during indexing
 }
 
 /* ============================================================
@@ -552,38 +797,9 @@ std::cout << "Indexing time (single-thread): "
 /* --------------------------------------------------
    2) MULTI-THREADED INDEXING
    -------------------------------------------------- */
-positionalIndex.clear();
-docLength.clear();
-for (size_t i = 0; i < documents.size(); i++) {
-    docLength[i] = 0;
-}
-
 auto multiStart = std::chrono::high_resolution_clock::now();
 
-int N = static_cast<int>(documents.size());
-int chunkSize = (N + numThreads - 1) / numThreads;
-
-std::vector<std::thread> threads;
-
-for (unsigned int i = 0; i < numThreads; i++) {
-    int start = i * chunkSize;
-    int end   = std::min(start + chunkSize, N);
-
-    if (start >= end) break;
-
-    threads.emplace_back(
-        indexDocuments,
-        start,
-        end,
-        std::cref(documents),
-        std::ref(positionalIndex),
-        std::ref(docLength)
-    );
-}
-
-for (auto& t : threads) {
-    t.join();
-}
+buildIndexParallel(documents, numThreads, positionalIndex, docLength);
 
 auto multiEnd = std::chrono::high_resolution_clock::now();
 
@@ -622,161 +838,150 @@ if (singleThreadTimeMs > 0 && multiThreadTimeMs > 0) {
     std::cout << "(Dataset too small to measure speedup accurately)\n";
 }
 
-/* ===============================
-   QUERY + TF-IDF RANKING + TOP-K
-   =============================== */
-
-std::cout << "\nEnter query: ";
-std::string query;
-std::getline(std::cin, query);
-
-if (query.empty()) {
-    std::cout << "Empty query. Please enter one or more words.\n";
-    return 0;
-}
+/* ============================================================
+   OPTIONAL: DOCUMENT REORDERING (DOCID REASSIGNMENT)
+   ============================================================
+   - Computes a new docID order from the index just built
+   - Renumbers documents and rebuilds; docIdToName follows
+   - Reports the change in varint-compressed posting size
+   ============================================================ */
+if (reorderMethod != ReorderMethod::None) {
+    PostingSizeStats before = measurePostingSize(positionalIndex);
 
-/* -------------------------------
-   START QUERY TIMER
-   ------------------------------- */
-auto queryStart = std::chrono::high_resolution_clock::now();
+    auto reorderStart = std::chrono::high_resolution_clock::now();
 
-/* ===============================
-   DETECT PHRASE QUERY
-   =============================== */
-bool isPhraseQuery = false;
+    std::vector<int> newToOld = computeDocOrder(
+        reorderMethod,
+        positionalIndex,
+        docIdToName,
+        static_cast<int>(documents.size())
+    );
 
-if (query.size() >= 2 && query.front() == '"' && query.back() == '"') {
-    isPhraseQuery = true;
-    query = query.substr(1, query.size() - 2);  // strip quotes
-}
+    auto reorderEnd = std::chrono::high_resolution_clock::now();
 
-// Tokenize AFTER stripping quotes
-auto queryTokens = tokenize(query);
+    documents = applyDocOrder(std::move(documents), newToOld);
 
-/* ===============================
-   PRESERVE ORDER FOR PHRASES
-   =============================== */
-std::vector<std::string> orderedQueryTokens;
-for (const auto& token : queryTokens) {
-    if (!stopWords.count(token)) {
-        orderedQueryTokens.push_back(token);
+    docIdToName.clear();
+    for (const auto& doc : documents) {
+        docIdToName[doc.id] = doc.path;
     }
-}
 
-if (orderedQueryTokens.empty()) {
-    std::cout << "No valid query terms after filtering stop words.\n";
-    return 0;
+    buildIndexParallel(documents, numThreads, positionalIndex, docLength);
+
+    PostingSizeStats after = measurePostingSize(positionalIndex);
+
+    auto pct = [](std::size_t from, std::size_t to) {
+        return from == 0 ? 0.0 : 100.0 * (1.0 - static_cast<double>(to) / from);
+    };
+
+    std::cout << "Doc reordering time: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     reorderEnd - reorderStart).count()
+              << " ms\n";
+    std::cout << "DocID+TF posting bytes: " << before.docBytes
+              << " -> " << after.docBytes
+              << " (-" << pct(before.docBytes, after.docBytes) << "%)\n";
+    std::cout << "Total posting bytes: "
+              << before.docBytes + before.positionBytes << " -> "
+              << after.docBytes + after.positionBytes
+              << " (-" << pct(before.docBytes + before.positionBytes,
+                             after.docBytes + after.positionBytes) << "%)\n";
 }
 
-/* ===============================
-   PHRASE QUERY PATH
-   =============================== */
-if (isPhraseQuery && orderedQueryTokens.size() >= 2) {
-
-    std::vector<int> matchingDocs;
-
-    const std::string& firstWord = orderedQueryTokens[0];
-    auto itFirst = positionalIndex.find(firstWord);
+/* ============================================================
+   PUBLISH INITIAL SNAPSHOT
+   ============================================================ */
+/* --------------------------------------------------
+   OPTIONAL: SAVE FOR FAST STARTUP (--open)
+   -------------------------------------------------- */
+if (!saveSegment.empty()) {
+    if (writeSegment(saveSegment, positionalIndex) &&
+        writeDocTable(saveSegment + ".docs", docIdToName, docLength)) {
+        std::cout << "Saved " << saveSegment << " + " << saveSegment << ".docs\n";
+    } else {
+        std::cerr << "Unable to save " << saveSegment << "\n";
+    }
+}
 
-    if (itFirst != positionalIndex.end()) {
+auto initialSnapshot = std::make_shared<IndexSnapshot>();
+initialSnapshot->positionalIndex = std::move(positionalIndex);
+initialSnapshot->docLength       = std::move(docLength);
+initialSnapshot->docIdToName     = std::move(docIdToName);
+initialSnapshot->totalDocs       = static_cast<int>(documents.size());
 
-        for (const auto& docPair : itFirst->second) {
-            int docID = docPair.first;
-            bool matchesAll = true;
+auto prepareStart = std::chrono::high_resolution_clock::now();
+prepareSnapshot(*initialSnapshot);
+auto prepareEnd = std::chrono::high_resolution_clock::now();
 
-            for (size_t i = 0; i + 1 < orderedQueryTokens.size(); i++) {
-                const std::string& w1 = orderedQueryTokens[i];
-                const std::string& w2 = orderedQueryTokens[i + 1];
+/* --------------------------------------------------
+   BIWORD INDEX OVERHEAD REPORT
+   -------------------------------------------------- */
+if (biwordMinFrequency > 0) {
+    PostingSizeStats mainSize   = measurePostingSize(initialSnapshot->positionalIndex);
+    PostingSizeStats biwordSize = measurePostingSize(initialSnapshot->biwordIndex);
+
+    std::size_t mainBytes   = mainSize.docBytes + mainSize.positionBytes;
+    std::size_t biwordBytes = biwordSize.docBytes + biwordSize.positionBytes;
+
+    std::cout << "Biword index (pairs >= " << biwordMinFrequency << "): "
+              << initialSnapshot->biwordIndex.size() << " pairs, "
+              << biwordSize.postings << " postings, "
+              << biwordBytes / 1024 << " KB compressed (+"
+              << (mainBytes ? 100.0 * biwordBytes / mainBytes : 0.0)
+              << "% of positional index), snapshot prepare "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     prepareEnd - prepareStart).count()
+              << " ms\n";
+}
 
-                if (!positionalIndex.count(w1) ||
-                    !positionalIndex.count(w2) ||
-                    !positionalIndex[w1].count(docID) ||
-                    !positionalIndex[w2].count(docID) ||
-                    !phraseMatchTwoWords(
-                        positionalIndex[w1][docID],
-                        positionalIndex[w2][docID])) {
-                    matchesAll = false;
-                    break;
-                }
-            }
+/* --------------------------------------------------
+   PRUNED TIER SIZE REPORT
+   -------------------------------------------------- */
+if (pruneFraction > 0.0) {
+    std::size_t fullPostings = 0, tier1Postings = 0;
+    for (const auto& [word, docMap] : initialSnapshot->positionalIndex) fullPostings += docMap.size();
+    for (const auto& [word, term] : initialSnapshot->prunedIndex) tier1Postings += term.postings.size();
+
+    std::cout << "Pruned tier 1 (top " << pruneFraction * 100.0 << "%, min "
+              << pruneMinPostings << " per term): " << tier1Postings << " of "
+              << fullPostings << " postings ("
+              << (fullPostings ? 100.0 * tier1Postings / fullPostings : 0.0) << "%)\n";
+}
 
-            if (matchesAll) {
-                matchingDocs.push_back(docID);
-            }
-        }
-    }
+snapshots.publish(std::move(initialSnapshot));
 
-    if (matchingDocs.empty()) {
-        std::cout << "No documents match the phrase.\n";
-    } else {
-        std::cout << "Phrase match found in:\n";
-        for (int docID : matchingDocs) {
-            std::cout << "- " << docIdToName[docID] << "\n";
-        }
-    }
+std::cout << "[startup] ready for queries after "
+          << std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now() - processStart).count()
+          << " ms\n";
 
+/* --------------------------------------------------
+   MEMORY ACCOUNTING (PER STRUCTURE)
+   -------------------------------------------------- */
+if (memReport) {
+    printMemoryReport(std::cout, measureMemory(*snapshots.acquire(), &documents));
+    std::cout << "process RSS: " << currentRssKb() / 1024 << " MB\n";
 }
-/* ===============================
-   RANKED QUERY PATH (TF-IDF)
-   =============================== */
-else {
-
-    std::unordered_set<std::string> dedupedTokens(
-        orderedQueryTokens.begin(),
-        orderedQueryTokens.end()
-    );
 
-    std::vector<std::string> queryTokenVector(
-        dedupedTokens.begin(),
-        dedupedTokens.end()
-    );
+if (runBench) {
+    std::vector<std::string> benchQueries = loadBenchQueries(benchQueryFile);
 
-    std::cout << "Enter K (press Enter for default 5): ";
-    std::string kInput;
-    std::getline(std::cin, kInput);
-
-    int K = 5;
-    if (!kInput.empty()) {
-        try {
-            K = std::stoi(kInput);
-            if (K <= 0) K = 5;
-        } catch (...) {
-            K = 5;
-        }
-    }
-
-    auto rankedResults = rankDocuments(
-        queryTokenVector,
-        positionalIndex,
-        docLength,
-        documents.size(),
-        K
-    );
+    runQueryBenchmark(snapshots, scheduler, benchQueries, benchOptions);
+    runShapeBenchmark(snapshots, benchOptions);
+    if (pruneFraction > 0.0) runPruningBenchmark(snapshots, benchQueries, benchOptions);
 
-    if (rankedResults.empty()) {
-        std::cout << "No query terms found in the index.\n";
-    } else {
-        int rank = 1;
-        for (const auto& p : rankedResults) {
-            std::cout << "Rank " << rank << ": "
-                      << docIdToName[p.first]
-                      << " (score: " << p.second << ")\n";
-            rank++;
+    if (!tieredSegment.empty()) {
+        if (!fs::exists(tieredSegment)) {
+            writeSegment(tieredSegment, snapshots.acquire()->positionalIndex);
         }
+        auto tiered = TieredIndex::open(tieredSegment, hotMb << 20);
+        if (!tiered) return 1;
+        runTieredBenchmark(snapshots, *tiered, benchQueries, benchOptions);
     }
+    return 0;
 }
 
-/* -------------------------------
-   END QUERY TIMER
-   ------------------------------- */
-auto queryEnd = std::chrono::high_resolution_clock::now();
-long long queryTimeMs =
-    std::chrono::duration_cast<std::chrono::milliseconds>(
-        queryEnd - queryStart
-    ).count();
-
-std::cout << "Query latency: " << queryTimeMs << " ms\n";
+runQueryLoop(snapshots, scheduler, reload, loadSegmentBuilder, benchOptions);
 
     return 0;
 }
-
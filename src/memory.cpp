@@ -0,0 +1,285 @@
+#include "memory.h"
+
+#include <atomic>
+#include <functional>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+const std::size_t NUM_CATEGORIES = static_cast<std::size_t>(MemoryCategory::Count);
+
+std::atomic<std::size_t> g_bytes[NUM_CATEGORIES];
+std::atomic<std::size_t> g_allocations[NUM_CATEGORIES];
+
+std::size_t slot(MemoryCategory category) {
+    return static_cast<std::size_t>(category);
+}
+
+/* ============================================================
+   TRACKED REPLICAS OF THE INDEX STRUCTURES
+   ============================================================ */
+
+template <MemoryCategory C>
+using TrackedString = std::basic_string<char, std::char_traits<char>, TrackingAllocator<char, C>>;
+
+struct TrackedStringHash {
+    template <class S>
+    std::size_t operator()(const S& s) const {
+        return std::hash<std::string_view>()(std::string_view(s.data(), s.size()));
+    }
+};
+
+template <class K, class V, MemoryCategory C, class Hash = std::hash<K>>
+using TrackedMap = std::unordered_map<
+    K, V, Hash, std::equal_to<K>, TrackingAllocator<std::pair<const K, V>, C>
+>;
+
+// Same capacity as s; short strings stay in the SSO buffer
+template <MemoryCategory C>
+TrackedString<C> replicateString(const std::string& s) {
+    TrackedString<C> copy;
+    copy.reserve(s.capacity());
+    copy.assign(s.data(), s.size());
+    return copy;
+}
+
+// Each replicate*() builds a tracked copy of one structure and
+// calls sample() while the copy is still alive.
+
+// term -> docID -> positions, each level charged separately.
+// Position vectors are reserved, not filled: only sizes matter.
+template <MemoryCategory Str, MemoryCategory Table, MemoryCategory Docs, MemoryCategory Pos, class Sample>
+void replicatePositionalIndex(const PositionalIndex& index, Sample sample) {
+    using PositionVector = std::vector<int, TrackingAllocator<int, Pos>>;
+    using DocMap = TrackedMap<int, PositionVector, Docs>;
+    using Key = TrackedString<Str>;
+
+    TrackedMap<Key, DocMap, Table, TrackedStringHash> replica;
+    replica.rehash(index.bucket_count());
+
+    for (const auto& [word, docMap] : index) {
+        DocMap& docs = replica.emplace(replicateString<Str>(word), DocMap()).first->second;
+        docs.rehash(docMap.bucket_count());
+
+        for (const auto& [docID, positions] : docMap) {
+            PositionVector copy;
+            copy.reserve(positions.capacity());
+            docs.emplace(docID, std::move(copy));
+        }
+    }
+    sample();
+}
+
+template <class Sample>
+void replicatePartitions(const std::vector<IndexPartition>& partitions, Sample sample) {
+    const MemoryCategory C = MemoryCategory::Partitions;
+    using PostingVector = std::vector<Posting, TrackingAllocator<Posting, C>>;
+    using Key = TrackedString<C>;
+
+    std::vector<TrackedMap<Key, PostingVector, C, TrackedStringHash>> postings(partitions.size());
+    std::vector<std::vector<int, TrackingAllocator<int, C>>> lengths(partitions.size());
+
+    for (std::size_t p = 0; p < partitions.size(); p++) {
+        const IndexPartition& partition = partitions[p];
+
+        postings[p].rehash(partition.postings.bucket_count());
+        for (const auto& [word, list] : partition.postings) {
+            PostingVector copy;
+            copy.reserve(list.capacity());
+            postings[p].emplace(replicateString<C>(word), std::move(copy));
+        }
+        lengths[p].reserve(partition.lengths.capacity());
+    }
+    sample();
+}
+
+template <class Sample>
+void replicatePrunedIndex(const PrunedIndex& prunedIndex, Sample sample) {
+    const MemoryCategory C = MemoryCategory::PrunedTier;
+    using PostingVector = std::vector<Posting, TrackingAllocator<Posting, C>>;
+
+    struct TrackedTerm {
+        PostingVector postings;
+        double maxPrunedTF;
+        int docFrequency;
+    };
+
+    TrackedMap<TrackedString<C>, TrackedTerm, C, TrackedStringHash> replica;
+    replica.rehash(prunedIndex.bucket_count());
+
+    for (const auto& [word, term] : prunedIndex) {
+        TrackedTerm copy{{}, term.maxPrunedTF, term.docFrequency};
+        copy.postings.reserve(term.postings.capacity());
+        replica.emplace(replicateString<C>(word), std::move(copy));
+    }
+    sample();
+}
+
+template <class Sample>
+void replicateDocTables(
+    const std::unordered_map<int, std::string>& docIdToName,
+    const std::unordered_map<int, int>& docLength,
+    Sample sample
+) {
+    using NameString = TrackedString<MemoryCategory::DocNames>;
+
+    TrackedMap<int, NameString, MemoryCategory::DocNames> names;
+    names.rehash(docIdToName.bucket_count());
+    for (const auto& [docID, name] : docIdToName) {
+        names.emplace(docID, replicateString<MemoryCategory::DocNames>(name));
+    }
+
+    TrackedMap<int, int, MemoryCategory::DocLengths> lengths;
+    lengths.rehash(docLength.bucket_count());
+    for (const auto& entry : docLength) lengths.emplace(entry);
+    sample();
+}
+
+template <class Sample>
+void replicateDocuments(const std::vector<Document>& documents, Sample sample) {
+    const MemoryCategory C = MemoryCategory::DocumentContent;
+
+    struct TrackedDocument {
+        int id;
+        TrackedString<C> path;
+        TrackedString<C> content;
+    };
+
+    std::vector<TrackedDocument, TrackingAllocator<TrackedDocument, C>> replica;
+    replica.reserve(documents.capacity());
+
+    for (const auto& doc : documents) {
+        TrackedDocument copy{doc.id, {}, {}};
+        copy.path.reserve(doc.path.capacity());
+        copy.content.reserve(doc.content.capacity());
+        replica.push_back(std::move(copy));
+    }
+    sample();
+}
+
+}  // namespace
+
+/* ============================================================
+   COUNTERS
+   ============================================================ */
+
+const char* memoryCategoryName(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::TermStrings:     return "term strings";
+        case MemoryCategory::TermTable:       return "term table";
+        case MemoryCategory::DocMaps:         return "per-term doc maps";
+        case MemoryCategory::Positions:       return "position vectors";
+        case MemoryCategory::DocNames:        return "docIdToName";
+        case MemoryCategory::DocLengths:      return "docLength";
+        case MemoryCategory::DocumentContent: return "document content";
+        case MemoryCategory::Partitions:      return "range partitions";
+        case MemoryCategory::Biwords:         return "biword index";
+        case MemoryCategory::PrunedTier:      return "pruned tier 1";
+        case MemoryCategory::Count:           break;
+    }
+    return "?";
+}
+
+void trackAllocation(MemoryCategory category, std::size_t bytes) {
+    g_bytes[slot(category)].fetch_add(bytes, std::memory_order_relaxed);
+    g_allocations[slot(category)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void trackDeallocation(MemoryCategory category, std::size_t bytes) {
+    g_bytes[slot(category)].fetch_sub(bytes, std::memory_order_relaxed);
+    g_allocations[slot(category)].fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::size_t MemoryReport::totalBytes() const {
+    std::size_t total = 0;
+    for (std::size_t b : bytes) total += b;
+    return total;
+}
+
+std::size_t MemoryReport::totalAllocations() const {
+    std::size_t total = 0;
+    for (std::size_t a : allocations) total += a;
+    return total;
+}
+
+/* ============================================================
+   MEASUREMENT
+   ============================================================
+   Each replica is built and destroyed in turn, so only one
+   structure's copy is alive at a time. The counters are read as
+   the difference across the replica's lifetime.
+   ============================================================ */
+
+MemoryReport measureMemory(
+    const IndexSnapshot& snapshot,
+    const std::vector<Document>* documents
+) {
+    MemoryReport report;
+
+    auto account = [&report](auto&& replicate) {
+        std::array<std::size_t, NUM_CATEGORIES> bytesBefore{}, allocsBefore{};
+        for (std::size_t c = 0; c < NUM_CATEGORIES; c++) {
+            bytesBefore[c]  = g_bytes[c].load();
+            allocsBefore[c] = g_allocations[c].load();
+        }
+
+        // Peak counters while the replica is alive
+        std::array<std::size_t, NUM_CATEGORIES> bytesPeak{}, allocsPeak{};
+        replicate([&]() {
+            for (std::size_t c = 0; c < NUM_CATEGORIES; c++) {
+                bytesPeak[c]  = g_bytes[c].load();
+                allocsPeak[c] = g_allocations[c].load();
+            }
+        });
+
+        for (std::size_t c = 0; c < NUM_CATEGORIES; c++) {
+            report.bytes[c]       += bytesPeak[c] - bytesBefore[c];
+            report.allocations[c] += allocsPeak[c] - allocsBefore[c];
+        }
+    };
+
+    account([&](auto sample) {
+        replicatePositionalIndex<MemoryCategory::TermStrings, MemoryCategory::TermTable,
+                                 MemoryCategory::DocMaps, MemoryCategory::Positions>(
+            snapshot.positionalIndex, sample);
+    });
+    account([&](auto sample) {
+        replicatePositionalIndex<MemoryCategory::Biwords, MemoryCategory::Biwords,
+                                 MemoryCategory::Biwords, MemoryCategory::Biwords>(
+            snapshot.biwordIndex, sample);
+    });
+    account([&](auto sample) { replicatePartitions(snapshot.partitions, sample); });
+    account([&](auto sample) { replicatePrunedIndex(snapshot.prunedIndex, sample); });
+    account([&](auto sample) {
+        replicateDocTables(snapshot.docIdToName, snapshot.docLength, sample);
+    });
+    if (documents) {
+        account([&](auto sample) { replicateDocuments(*documents, sample); });
+    }
+
+    return report;
+}
+
+void printMemoryReport(std::ostream& out, const MemoryReport& report) {
+    const double MB = 1024.0 * 1024.0;
+    const double total = static_cast<double>(report.totalBytes());
+
+    out << "\n=== Memory by structure (allocator-requested bytes) ===\n";
+    for (std::size_t c = 0; c < NUM_CATEGORIES; c++) {
+        if (report.allocations[c] == 0) continue;
+
+        out << std::left << std::setw(20) << memoryCategoryName(static_cast<MemoryCategory>(c))
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(9) << report.bytes[c] / MB << " MB"
+            << std::setw(7) << (total > 0 ? 100.0 * report.bytes[c] / total : 0.0) << "%"
+            << std::setw(12) << report.allocations[c] << " allocs\n";
+    }
+    out << std::left << std::setw(20) << "total"
+        << std::right << std::setw(9) << total / MB << " MB"
+        << std::setw(20) << report.totalAllocations() << " allocs\n";
+    out.unsetf(std::ios::floatfield);
+    out << std::setprecision(6);
+}
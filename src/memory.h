@@ -0,0 +1,103 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "indexer.h"
+#include "snapshot.h"
+
+// ============================================================
+// Per-structure memory accounting
+// ============================================================
+//
+// TrackingAllocator<T, C> forwards to std::allocator and adds
+// every allocation to the counter of category C. Rebinding keeps
+// the category, so a container's nodes and bucket array are all
+// charged to the category it was declared with.
+//
+// measureMemory() rebuilds each structure with the same shape
+// (bucket counts, string and vector capacities) in containers
+// whose every level uses its own category, then reads the
+// counters. The result is the exact number of bytes the standard
+// library requests for that layout; malloc's per-chunk header
+// is not included, so allocation counts are reported too.
+//
+enum class MemoryCategory {
+    TermStrings,      // index term keys (heap part beyond SSO)
+    TermTable,        // outer map: nodes + buckets
+    DocMaps,          // per-term docID maps: nodes + buckets
+    Positions,        // position vectors
+    DocNames,         // docIdToName
+    DocLengths,       // docLength
+    DocumentContent,  // retained Document::path / content
+    Partitions,       // docID-range partitions (all levels)
+    Biwords,          // biword index (all levels)
+    PrunedTier,       // tier-1 postings of the pruned index
+    Count
+};
+
+const char* memoryCategoryName(MemoryCategory category);
+
+// Global counters (bytes currently allocated / allocation calls)
+void trackAllocation(MemoryCategory category, std::size_t bytes);
+void trackDeallocation(MemoryCategory category, std::size_t bytes);
+
+template <class T, MemoryCategory C>
+class TrackingAllocator {
+public:
+    using value_type = T;
+
+    template <class U>
+    struct rebind {
+        using other = TrackingAllocator<U, C>;
+    };
+
+    TrackingAllocator() noexcept = default;
+
+    template <class U>
+    TrackingAllocator(const TrackingAllocator<U, C>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        T* p = std::allocator<T>().allocate(n);
+        trackAllocation(C, n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        trackDeallocation(C, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <class U>
+    bool operator==(const TrackingAllocator<U, C>&) const noexcept { return true; }
+
+    template <class U>
+    bool operator!=(const TrackingAllocator<U, C>&) const noexcept { return false; }
+};
+
+// Bytes and allocation calls per category
+struct MemoryReport {
+    std::array<std::size_t, static_cast<std::size_t>(MemoryCategory::Count)> bytes{};
+    std::array<std::size_t, static_cast<std::size_t>(MemoryCategory::Count)> allocations{};
+
+    std::size_t totalBytes() const;
+    std::size_t totalAllocations() const;
+};
+
+// Accounts the snapshot's structures and, if given, the
+// documents retained by the loader. Replicas are built one at a
+// time, so peak memory grows by the largest structure (usually
+// the positional index) while it runs; not meant for the query
+// path.
+MemoryReport measureMemory(
+    const IndexSnapshot& snapshot,
+    const std::vector<Document>* documents
+);
+
+void printMemoryReport(std::ostream& out, const MemoryReport& report);
+
+#endif
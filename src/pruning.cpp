@@ -0,0 +1,261 @@
+#include "pruning.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Bitmask of matched query terms per candidate
+const size_t MAX_PRUNED_QUERY_TERMS = 64;
+
+// Slack for comparing bounds with sums taken in another order
+const double BOUND_EPSILON = 1e-9;
+
+}  // namespace
+
+/* ============================================================
+   TIER-1 CONSTRUCTION
+   ============================================================ */
+
+PrunedIndex buildPrunedIndex(
+    const PositionalIndex& positionalIndex,
+    const std::unordered_map<int,int>& docLength,
+    double keepFraction,
+    int minPostings
+) {
+    PrunedIndex prunedIndex;
+    prunedIndex.reserve(positionalIndex.size());
+
+    struct Impact {
+        double tf;
+        Posting posting;
+    };
+    vector<Impact> impacts;
+
+    for (const auto& [word, docMap] : positionalIndex) {
+        impacts.clear();
+
+        // Postings without a length never score (as in rankDocuments)
+        for (const auto& [docID, positions] : docMap) {
+            auto lenIt = docLength.find(docID);
+            if (lenIt == docLength.end()) continue;
+
+            int freq = static_cast<int>(positions.size());
+            impacts.push_back({computeTF(freq, lenIt->second), {docID, freq}});
+        }
+
+        size_t keep = std::max<size_t>(
+            static_cast<size_t>(minPostings),
+            static_cast<size_t>(std::ceil(keepFraction * docMap.size()))
+        );
+        keep = std::min(keep, impacts.size());
+
+        // Highest TF first; docID breaks ties so the cut is deterministic
+        auto higherImpact = [](const Impact& a, const Impact& b) {
+            if (a.tf != b.tf) return a.tf > b.tf;
+            return a.posting.docID < b.posting.docID;
+        };
+        if (keep < impacts.size()) {
+            std::nth_element(impacts.begin(), impacts.begin() + keep, impacts.end(), higherImpact);
+        }
+
+        PrunedTerm& term = prunedIndex[word];
+        term.docFrequency = static_cast<int>(docMap.size());
+
+        for (size_t i = keep; i < impacts.size(); i++) {
+            term.maxPrunedTF = std::max(term.maxPrunedTF, impacts[i].tf);
+        }
+
+        term.postings.reserve(keep);
+        for (size_t i = 0; i < keep; i++) term.postings.push_back(impacts[i].posting);
+        std::sort(term.postings.begin(), term.postings.end(),
+                  [](const Posting& a, const Posting& b) { return a.docID < b.docID; });
+    }
+
+    return prunedIndex;
+}
+
+/* ============================================================
+   TWO-TIER EVALUATION
+   ============================================================ */
+
+bool rankPruned(
+    const PrunedIndex& prunedIndex,
+    const PositionalIndex& positionalIndex,
+    const vector<string>& queryTokens,
+    const std::unordered_map<int,int>& docLength,
+    int totalDocs,
+    int K,
+    vector<pair<int,double>>& results,
+    QueryBudget* budget
+) {
+    if (queryTokens.size() > MAX_PRUNED_QUERY_TERMS || K <= 0) return false;
+
+    BudgetMeter meter(budget);
+    bool stopped = false;
+
+    const size_t numTerms = queryTokens.size();
+    vector<const PrunedTerm*> tier1(numTerms, nullptr);
+    vector<const std::unordered_map<int, vector<int>>*> full(numTerms, nullptr);
+    vector<double> idfs(numTerms, 0.0);
+    vector<double> missingBound(numTerms, 0.0);
+
+    double unseenBound = 0.0;
+    bool anyPruned = false;
+
+    for (size_t t = 0; t < numTerms; t++) {
+        auto it = prunedIndex.find(queryTokens[t]);
+        auto fullIt = positionalIndex.find(queryTokens[t]);
+        if (it == prunedIndex.end() || fullIt == positionalIndex.end()) continue;
+
+        tier1[t] = &it->second;
+        full[t]  = &fullIt->second;
+        idfs[t]  = computeIDF(totalDocs, it->second.docFrequency);
+
+        missingBound[t] = it->second.maxPrunedTF * idfs[t];
+        unseenBound += missingBound[t];
+        anyPruned = anyPruned || it->second.maxPrunedTF > 0.0;
+    }
+
+    /* ------------------------------------------------------------
+       1) TIER-1 SCORES AND UPPER BOUNDS
+       ------------------------------------------------------------ */
+    struct Partial {
+        double score = 0.0;
+        uint64_t matched = 0;
+    };
+    std::unordered_map<int, Partial> partials;
+
+    for (size_t t = 0; t < numTerms && !stopped; t++) {
+        if (!tier1[t]) continue;
+
+        for (const Posting& p : tier1[t]->postings) {
+            if (!meter.tick()) {
+                stopped = true;
+                break;
+            }
+
+            auto lenIt = docLength.find(p.docID);
+            if (lenIt == docLength.end()) continue;
+
+            Partial& partial = partials[p.docID];
+            partial.score += computeTF(p.freq, lenIt->second) * idfs[t];
+            partial.matched |= uint64_t(1) << t;
+        }
+    }
+
+    // Out of budget: rank on the tier-1 scores gathered so far
+    if (stopped) {
+        vector<pair<int,double>> ranked;
+        ranked.reserve(partials.size());
+        for (const auto& [docID, partial] : partials) ranked.emplace_back(docID, partial.score);
+        results = mergeTopK({std::move(ranked)}, K);
+        return true;
+    }
+
+    vector<pair<double,int>> candidates;  // {upper bound, docID}
+    candidates.reserve(partials.size());
+
+    for (const auto& [docID, partial] : partials) {
+        double upper = partial.score;
+        for (size_t t = 0; t < numTerms; t++) {
+            if (!(partial.matched & (uint64_t(1) << t))) upper += missingBound[t];
+        }
+        candidates.emplace_back(upper, docID);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const pair<double,int>& a, const pair<double,int>& b) { return a.first > b.first; });
+
+    /* ------------------------------------------------------------
+       2) EXACT SCORES FOR CANDIDATES THAT CAN STILL MAKE TOP-K
+       ------------------------------------------------------------
+       Summed in query-term order from the full index, exactly
+       as rankDocuments does, so scores are bit-identical.
+       ------------------------------------------------------------ */
+    auto worse = [](const pair<int,double>& a, const pair<int,double>& b) {
+        if (a.second != b.second) return a.second > b.second;
+        return a.first > b.first;
+    };
+    std::priority_queue<pair<int,double>, vector<pair<int,double>>, decltype(worse)> heap(worse);
+
+    for (const auto& [upper, docID] : candidates) {
+        if (static_cast<int>(heap.size()) == K && upper + BOUND_EPSILON < heap.top().second) break;
+
+        const int len = docLength.at(docID);
+        double exact = 0.0;
+
+        for (size_t t = 0; t < numTerms && !stopped; t++) {
+            if (!full[t]) continue;
+            auto docIt = full[t]->find(docID);
+            if (docIt == full[t]->end()) continue;
+
+            if (!meter.tick()) {
+                stopped = true;
+                break;
+            }
+            exact += computeTF(static_cast<int>(docIt->second.size()), len) * idfs[t];
+        }
+        if (stopped) break;
+
+        pair<int,double> candidate(docID, exact);
+        if (static_cast<int>(heap.size()) < K) {
+            heap.push(candidate);
+        } else if (worse(candidate, heap.top())) {
+            heap.pop();
+            heap.push(candidate);
+        }
+    }
+
+    /* ------------------------------------------------------------
+       3) SAFETY CHECK AGAINST DOCS TIER 1 NEVER SAW
+       ------------------------------------------------------------
+       Skipped when out of budget: the exact scores found so far
+       are returned as partial results.
+       ------------------------------------------------------------ */
+    if (!stopped) {
+        if (static_cast<int>(heap.size()) < K) {
+            if (anyPruned) return false;
+        } else if (!(unseenBound + BOUND_EPSILON < heap.top().second)) {
+            return false;
+        }
+    }
+
+    results.clear();
+    while (!heap.empty()) {
+        results.push_back(heap.top());
+        heap.pop();
+    }
+    std::reverse(results.begin(), results.end());
+    return true;
+}
+
+vector<pair<int,double>> rankTier1Only(
+    const PrunedIndex& prunedIndex,
+    const vector<string>& queryTokens,
+    const std::unordered_map<int,int>& docLength,
+    int totalDocs,
+    int K
+) {
+    std::unordered_map<int, double> docScores;
+
+    for (const auto& token : queryTokens) {
+        auto it = prunedIndex.find(token);
+        if (it == prunedIndex.end()) continue;
+
+        double idf = computeIDF(totalDocs, it->second.docFrequency);
+        for (const Posting& p : it->second.postings) {
+            auto lenIt = docLength.find(p.docID);
+            if (lenIt == docLength.end()) continue;
+            docScores[p.docID] += computeTF(p.freq, lenIt->second) * idf;
+        }
+    }
+
+    vector<pair<int,double>> ranked(docScores.begin(), docScores.end());
+    return mergeTopK({std::move(ranked)}, K);
+}
@@ -0,0 +1,70 @@
+#ifndef PRUNING_H
+#define PRUNING_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "indexer.h"
+#include "ranker.h"
+
+// ============================================================
+// Static index pruning (two-tier evaluation)
+// ============================================================
+//
+// Tier 1 keeps, per term, only the postings with the highest
+// TF (= highest TF-IDF contribution, IDF being per term) plus the
+// largest TF among the dropped ones. A query is scored on tier 1,
+// the most promising candidates are completed with exact scores
+// from the full index, and the answer is accepted only if no
+// other document can reach the K-th exact score:
+//
+//   unseen doc  <= sum over terms of maxPrunedTF * idf
+//   seen doc    <= tier-1 score + bounds of its missing terms
+//
+// Otherwise the caller falls back to the full index, so accepted
+// results are always identical to rankDocuments().
+//
+struct PrunedTerm {
+    std::vector<Posting> postings;  // kept postings, docID order
+    double maxPrunedTF = 0.0;       // 0 when nothing was dropped
+    int docFrequency = 0;           // full df (for the IDF)
+};
+
+using PrunedIndex = std::unordered_map<std::string, PrunedTerm>;
+
+// Keeps max(minPostings, keepFraction * df) postings per term
+PrunedIndex buildPrunedIndex(
+    const PositionalIndex& positionalIndex,
+    const std::unordered_map<int,int>& docLength,
+    double keepFraction,
+    int minPostings
+);
+
+// Two-tier Top-K. Returns false (results untouched) when the bound
+// cannot certify the tier-1 answer and the full index is needed;
+// the tier-1 work stays charged to the budget, so the fallback
+// continues the same budget. If the budget runs out first, returns
+// true with the best results so far (budget->exhausted is set).
+bool rankPruned(
+    const PrunedIndex& prunedIndex,
+    const PositionalIndex& positionalIndex,
+    const std::vector<std::string>& queryTokens,
+    const std::unordered_map<int,int>& docLength,
+    int totalDocs,
+    int K,
+    std::vector<std::pair<int,double>>& results,
+    QueryBudget* budget = nullptr
+);
+
+// Top-K on tier 1 alone, without the safety check (recall baseline)
+std::vector<std::pair<int,double>> rankTier1Only(
+    const PrunedIndex& prunedIndex,
+    const std::vector<std::string>& queryTokens,
+    const std::unordered_map<int,int>& docLength,
+    int totalDocs,
+    int K
+);
+
+#endif
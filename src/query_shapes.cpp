@@ -0,0 +1,136 @@
+#include "query_shapes.h"
+
+namespace {
+
+template <std::size_t N, std::size_t K>
+std::vector<std::pair<int,double>> rankShape(
+    const IndexPartition& partition,
+    const std::vector<const std::vector<Posting>*>& postingLists,
+    const std::vector<double>& idfs,
+    int limit,
+    QueryBudget* budget
+) {
+    std::array<const std::vector<Posting>*, N> lists;
+    std::array<double, N> termIdfs;
+
+    for (std::size_t t = 0; t < N; t++) {
+        lists[t] = postingLists[t];
+        termIdfs[t] = idfs[t];
+    }
+
+    return rankRangeFixed<N, K>(lists, termIdfs, partition.lengths, partition.docBegin, limit, budget);
+}
+
+template <std::size_t K>
+bool dispatchTermCount(
+    const IndexPartition& partition,
+    const std::vector<const std::vector<Posting>*>& postingLists,
+    const std::vector<double>& idfs,
+    int limit,
+    QueryBudget* budget,
+    std::vector<std::pair<int,double>>& out
+) {
+    switch (postingLists.size()) {
+        case 1: out = rankShape<1, K>(partition, postingLists, idfs, limit, budget); return true;
+        case 2: out = rankShape<2, K>(partition, postingLists, idfs, limit, budget); return true;
+        case 3: out = rankShape<3, K>(partition, postingLists, idfs, limit, budget); return true;
+        default: return false;
+    }
+}
+
+template <std::size_t N>
+std::vector<int> phraseShape(
+    const PositionalIndex& positionalIndex,
+    const std::vector<std::string>& terms
+) {
+    std::array<const std::unordered_map<int, std::vector<int>>*, N> docMaps;
+
+    for (std::size_t t = 0; t < N; t++) {
+        auto it = positionalIndex.find(terms[t]);
+        if (it == positionalIndex.end()) return {};
+        docMaps[t] = &it->second;
+    }
+    return matchPhraseFixed<N>(docMaps);
+}
+
+}  // namespace
+
+std::vector<std::pair<int,double>> rankPartition(
+    const IndexPartition& partition,
+    const std::vector<const std::vector<Posting>*>& postingLists,
+    const std::vector<double>& idfs,
+    const std::unordered_map<int,int>& docLength,
+    int K,
+    QueryBudget* budget
+) {
+    std::vector<std::pair<int,double>> ranked;
+
+    if (!partition.lengths.empty() && K > 0) {
+        if (K <= 10 && dispatchTermCount<10>(partition, postingLists, idfs, K, budget, ranked)) {
+            return ranked;
+        }
+        if (K <= 100 && dispatchTermCount<100>(partition, postingLists, idfs, K, budget, ranked)) {
+            return ranked;
+        }
+    }
+
+    return rankDocumentRange(
+        postingLists, idfs, docLength,
+        partition.docBegin, partition.docEnd, K, budget
+    );
+}
+
+std::vector<int> matchPhrase(
+    const PositionalIndex& positionalIndex,
+    const std::vector<std::string>& terms
+) {
+    switch (terms.size()) {
+        case 2: return phraseShape<2>(positionalIndex, terms);
+        case 3: return phraseShape<3>(positionalIndex, terms);
+        default: return matchPhraseGeneric(positionalIndex, terms);
+    }
+}
+
+std::vector<int> matchPhraseGeneric(
+    const PositionalIndex& positionalIndex,
+    const std::vector<std::string>& terms
+) {
+    std::vector<int> matchingDocs;
+    if (terms.empty()) return matchingDocs;
+
+    auto itFirst = positionalIndex.find(terms[0]);
+    if (itFirst == positionalIndex.end()) return matchingDocs;
+
+    for (const auto& docPair : itFirst->second) {
+        int docID = docPair.first;
+        bool matchesAll = true;
+
+        for (size_t i = 0; i + 1 < terms.size(); i++) {
+            auto it1 = positionalIndex.find(terms[i]);
+            auto it2 = positionalIndex.find(terms[i + 1]);
+
+            if (it1 == positionalIndex.end() ||
+                it2 == positionalIndex.end()) {
+                matchesAll = false;
+                break;
+            }
+
+            auto p1 = it1->second.find(docID);
+            auto p2 = it2->second.find(docID);
+
+            if (p1 == it1->second.end() ||
+                p2 == it2->second.end() ||
+                !phraseMatchTwoWords(p1->second, p2->second)) {
+                matchesAll = false;
+                break;
+            }
+        }
+
+        if (matchesAll) {
+            matchingDocs.push_back(docID);
+        }
+    }
+
+    std::sort(matchingDocs.begin(), matchingDocs.end());
+    return matchingDocs;
+}
@@ -0,0 +1,185 @@
+#ifndef QUERY_SHAPES_H
+#define QUERY_SHAPES_H
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "indexer.h"
+#include "ranker.h"
+#include "snapshot.h"
+
+// ============================================================
+// Compile-time specialized query evaluators
+// ============================================================
+//
+// Most queries have 1-3 terms and ask for a small K. For those
+// shapes the term count N and heap capacity K are template
+// parameters, so the per-posting loops unroll, the Top-K heap
+// is a fixed std::array and scoring is a document-at-a-time
+// merge of docID-sorted postings (no hash map, no score array).
+//
+// rankPartition() / matchPhrase() pick the evaluator at runtime
+// and fall back to the generic code for every other shape.
+//
+
+// Bounded Top-K heap with capacity fixed at compile time.
+// Front of the heap is the worst kept result.
+template <std::size_t K>
+class FixedTopK {
+public:
+    void push(int docID, double score) {
+        std::pair<int,double> candidate(docID, score);
+
+        if (size_ < K) {
+            heap_[size_++] = candidate;
+            std::push_heap(heap_.begin(), heap_.begin() + size_, better);
+        } else if (better(candidate, heap_[0])) {
+            std::pop_heap(heap_.begin(), heap_.end(), better);
+            heap_[K - 1] = candidate;
+            std::push_heap(heap_.begin(), heap_.end(), better);
+        }
+    }
+
+    // Best-first, truncated to limit
+    std::vector<std::pair<int,double>> results(std::size_t limit) const {
+        std::vector<std::pair<int,double>> out(heap_.begin(), heap_.begin() + size_);
+        std::sort(out.begin(), out.end(), better);
+        if (out.size() > limit) out.resize(limit);
+        return out;
+    }
+
+private:
+    static bool better(const std::pair<int,double>& a, const std::pair<int,double>& b) {
+        if (a.second != b.second) return a.second > b.second;
+        return a.first > b.first;
+    }
+
+    std::array<std::pair<int,double>, K> heap_;
+    std::size_t size_ = 0;
+};
+
+// N-term OR query over one partition, document-at-a-time.
+// lengths[docID - docBegin] is the doc's token count.
+template <std::size_t N, std::size_t K>
+std::vector<std::pair<int,double>> rankRangeFixed(
+    const std::array<const std::vector<Posting>*, N>& lists,
+    const std::array<double, N>& idfs,
+    const std::vector<int>& lengths,
+    int docBegin,
+    int limit,
+    QueryBudget* budget
+) {
+    std::array<const Posting*, N> cur{};
+    std::array<const Posting*, N> end{};
+
+    for (std::size_t t = 0; t < N; t++) {
+        if (lists[t]) {
+            cur[t] = lists[t]->data();
+            end[t] = lists[t]->data() + lists[t]->size();
+        }
+    }
+
+    FixedTopK<K> top;
+    BudgetMeter meter(budget);
+    bool stopped = false;
+
+    while (!stopped) {
+        int docID = INT_MAX;
+        for (std::size_t t = 0; t < N; t++) {
+            if (cur[t] != end[t] && cur[t]->docID < docID) docID = cur[t]->docID;
+        }
+        if (docID == INT_MAX) break;
+
+        const int len = lengths[docID - docBegin];
+        double score = 0.0;
+
+        // Same term order as rankDocuments, so sums are bit-identical
+        for (std::size_t t = 0; t < N && !stopped; t++) {
+            if (cur[t] != end[t] && cur[t]->docID == docID) {
+                // Charged per posting, like the term-at-a-time paths
+                if (!meter.tick()) {
+                    stopped = true;
+                    break;
+                }
+                score += computeTF(cur[t]->freq, len) * idfs[t];
+                ++cur[t];
+            }
+        }
+        if (!stopped) top.push(docID, score);
+    }
+    meter.finish();
+
+    return top.results(static_cast<std::size_t>(limit));
+}
+
+// N-term phrase: every consecutive pair must be adjacent in the
+// doc (same rule as the generic path). Candidates are drawn from
+// the rarest term. Returns matching docIDs in ascending order.
+template <std::size_t N>
+std::vector<int> matchPhraseFixed(const std::array<const std::unordered_map<int, std::vector<int>>*, N>& docMaps) {
+    std::size_t rarest = 0;
+    for (std::size_t t = 1; t < N; t++) {
+        if (docMaps[t]->size() < docMaps[rarest]->size()) rarest = t;
+    }
+
+    std::vector<int> matchingDocs;
+
+    for (const auto& docPair : *docMaps[rarest]) {
+        const int docID = docPair.first;
+
+        std::array<const std::vector<int>*, N> positions{};
+        bool present = true;
+
+        for (std::size_t t = 0; t < N && present; t++) {
+            if (t == rarest) {
+                positions[t] = &docPair.second;
+                continue;
+            }
+            auto it = docMaps[t]->find(docID);
+            present = it != docMaps[t]->end();
+            if (present) positions[t] = &it->second;
+        }
+        if (!present) continue;
+
+        bool matchesAll = true;
+        for (std::size_t t = 0; t + 1 < N && matchesAll; t++) {
+            matchesAll = phraseMatchTwoWords(*positions[t], *positions[t + 1]);
+        }
+        if (matchesAll) matchingDocs.push_back(docID);
+    }
+
+    std::sort(matchingDocs.begin(), matchingDocs.end());
+    return matchingDocs;
+}
+
+// Ranks one partition, dispatching to a specialized evaluator for
+// 1-3 terms with K <= 100; generic rankDocumentRange otherwise.
+std::vector<std::pair<int,double>> rankPartition(
+    const IndexPartition& partition,
+    const std::vector<const std::vector<Posting>*>& postingLists,
+    const std::vector<double>& idfs,
+    const std::unordered_map<int,int>& docLength,
+    int K,
+    QueryBudget* budget = nullptr
+);
+
+// Phrase matching with 2/3-term specializations; terms are the
+// stop-word filtered phrase in order. Sorted docIDs.
+std::vector<int> matchPhrase(
+    const PositionalIndex& positionalIndex,
+    const std::vector<std::string>& terms
+);
+
+// Generic phrase matcher (any length), also used as the baseline
+std::vector<int> matchPhraseGeneric(
+    const PositionalIndex& positionalIndex,
+    const std::vector<std::string>& terms
+);
+
+#endif
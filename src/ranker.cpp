@@ -1,6 +1,7 @@
 #include "ranker.h"
 #include <cmath>
 #include <queue>
+#include <algorithm>
 
 using std::vector;
 using std::string;
@@ -19,6 +20,44 @@ double computeIDF(int totalDocs, int docsWithTerm) {
     return std::log(static_cast<double>(totalDocs) / docsWithTerm);
 }
 
+// Reserves postings against the budget
+std::size_t QueryBudget::reserve(std::size_t n) {
+    if (exhausted.load(std::memory_order_relaxed)) return 0;
+    if (std::chrono::steady_clock::now() > deadline) {
+        exhausted = true;
+        return 0;
+    }
+
+    std::size_t used = postingsScored.load(std::memory_order_relaxed);
+    std::size_t granted;
+    do {
+        if (used >= maxPostings) {
+            exhausted = true;
+            return 0;
+        }
+        granted = std::min(n, maxPostings - used);
+    } while (!postingsScored.compare_exchange_weak(used, used + granted, std::memory_order_relaxed));
+
+    return granted;
+}
+
+void QueryBudget::release(std::size_t n) {
+    if (n > 0) postingsScored.fetch_sub(n, std::memory_order_relaxed);
+}
+
+// Starts a new batch once the current one is used up
+bool BudgetMeter::refill() {
+    batch_ = budget_->reserve(QueryBudget::BUDGET_CHECK_INTERVAL);
+    pending_ = 0;
+    return batch_ > 0;
+}
+
+void BudgetMeter::finish() {
+    if (budget_) budget_->release(batch_ - pending_);
+    pending_ = 0;
+    batch_ = 0;
+}
+
 // Computes TF-IDF scores for query documents using positional index
 std::vector<std::pair<int,double>> rankDocuments(
     const std::vector<std::string>& queryTokens,
@@ -28,12 +67,17 @@ std::vector<std::pair<int,double>> rankDocuments(
     >& positionalIndex,
     const std::unordered_map<int,int>& docLength,
     int totalDocs,
-    int K
+    int K,
+    QueryBudget* budget
 ) {
     unordered_map<int, double> docScores;
+    BudgetMeter meter(budget);
+    bool stopped = false;
 
     // Accumulate TF-IDF scores across all query terms
     for (const auto& token : queryTokens) {
+        if (stopped) break;
+
         auto it = positionalIndex.find(token);
         if (it == positionalIndex.end()) continue;
 
@@ -42,6 +86,11 @@ std::vector<std::pair<int,double>> rankDocuments(
         double idf = computeIDF(totalDocs, docsWithTerm);
 
         for (const auto& docPair : posting) {
+            if (!meter.tick()) {
+                stopped = true;
+                break;
+            }
+
             int docID = docPair.first;
             int freq  = docPair.second.size(); // TF from positions
 
@@ -53,6 +102,8 @@ std::vector<std::pair<int,double>> rankDocuments(
         }
     }
 
+    meter.finish();
+
     // Rank documents using max-heap (priority queue)
     std::priority_queue<std::pair<double, int>> pq;
     for (const auto& entry : docScores) {
@@ -73,3 +124,98 @@ std::vector<std::pair<int,double>> rankDocuments(
 
     return rankedResults;
 }
+
+// Orders (score, docID) so that the "better" result compares greater
+static bool betterResult(const pair<int,double>& a, const pair<int,double>& b) {
+    if (a.second != b.second) return a.second > b.second;
+    return a.first > b.first;
+}
+
+// Scores a single docID range with precomputed IDFs
+std::vector<std::pair<int,double>> rankDocumentRange(
+    const std::vector<const std::vector<Posting>*>& postingLists,
+    const std::vector<double>& idfs,
+    const std::unordered_map<int,int>& docLength,
+    int docBegin,
+    int docEnd,
+    int K,
+    QueryBudget* budget
+) {
+    const int rangeSize = docEnd - docBegin;
+    vector<double> scores(rangeSize, 0.0);
+    vector<char> touched(rangeSize, 0);
+    BudgetMeter meter(budget);
+    bool stopped = false;
+
+    // Term-at-a-time accumulation into dense per-range arrays
+    for (size_t t = 0; t < postingLists.size() && !stopped; t++) {
+        if (!postingLists[t]) continue;
+        const double idf = idfs[t];
+
+        for (const Posting& p : *postingLists[t]) {
+            if (!meter.tick()) {
+                stopped = true;
+                break;
+            }
+
+            // Lists may come from on-disk data: ignore docIDs outside the range
+            if (p.docID < docBegin || p.docID >= docEnd) continue;
+
+            auto lenIt = docLength.find(p.docID);
+            if (lenIt == docLength.end()) continue;
+
+            const int slot = p.docID - docBegin;
+            scores[slot] += computeTF(p.freq, lenIt->second) * idf;
+            touched[slot] = 1;
+        }
+    }
+
+    meter.finish();
+
+    // Bounded min-heap: top() is the worst of the current Top-K
+    auto worse = [](const pair<int,double>& a, const pair<int,double>& b) {
+        return betterResult(a, b);
+    };
+    std::priority_queue<pair<int,double>, vector<pair<int,double>>, decltype(worse)> heap(worse);
+
+    for (int slot = 0; slot < rangeSize; slot++) {
+        if (!touched[slot]) continue;
+
+        pair<int,double> candidate(docBegin + slot, scores[slot]);
+        if (static_cast<int>(heap.size()) < K) {
+            heap.push(candidate);
+        } else if (betterResult(candidate, heap.top())) {
+            heap.pop();
+            heap.push(candidate);
+        }
+    }
+
+    vector<pair<int,double>> rankedResults;
+    rankedResults.reserve(heap.size());
+    while (!heap.empty()) {
+        rankedResults.push_back(heap.top());
+        heap.pop();
+    }
+    std::reverse(rankedResults.begin(), rankedResults.end());
+
+    return rankedResults;
+}
+
+// Merges per-range Top-K lists
+std::vector<std::pair<int,double>> mergeTopK(
+    const std::vector<std::vector<std::pair<int,double>>>& partials,
+    int K
+) {
+    vector<pair<int,double>> merged;
+    for (const auto& partial : partials) {
+        merged.insert(merged.end(), partial.begin(), partial.end());
+    }
+
+    if (static_cast<int>(merged.size()) > K) {
+        std::partial_sort(merged.begin(), merged.begin() + K, merged.end(), betterResult);
+        merged.resize(K);
+    } else {
+        std::sort(merged.begin(), merged.end(), betterResult);
+    }
+    return merged;
+}
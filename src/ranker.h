@@ -5,6 +5,71 @@
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+// Per-query deadline and work budget, checked cooperatively by
+// the evaluators through a BudgetMeter. Shared by all tasks of a
+// query: once one task exhausts it, the others stop at their
+// next check and return what they have scored.
+struct QueryBudget {
+    static constexpr std::size_t BUDGET_CHECK_INTERVAL = 1024;
+
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::time_point::max();
+    std::size_t maxPostings = std::numeric_limits<std::size_t>::max();
+
+    // Reserved by running meters, exact once they have finished
+    std::atomic<std::size_t> postingsScored{0};
+    std::atomic<bool> exhausted{false};  // results are partial
+
+    // Reserves up to n postings (fewer if less is left); 0 once
+    // the budget is spent or the deadline has passed
+    std::size_t reserve(std::size_t n);
+
+    // Returns reserved postings that were not scored
+    void release(std::size_t n);
+
+    // Cancels the query from outside (e.g. client went away)
+    void cancel() { exhausted = true; }
+};
+
+// Per-call view of a QueryBudget (null: unlimited). Every
+// evaluator calls tick() once per posting it is about to score,
+// so a query costs the same whichever evaluator runs it. Postings
+// are reserved in batches of min(BUDGET_CHECK_INTERVAL, remaining)
+// and the unused part is released by finish(), which keeps the
+// shared atomics off the hot path. Concurrent meters never score
+// more than the budget together; one may stop early while another
+// still holds an unused reservation.
+class BudgetMeter {
+public:
+    explicit BudgetMeter(QueryBudget* budget) : budget_(budget) {}
+    ~BudgetMeter() { finish(); }
+
+    BudgetMeter(const BudgetMeter&) = delete;
+    BudgetMeter& operator=(const BudgetMeter&) = delete;
+
+    // False once the budget cannot pay for one more posting
+    bool tick() {
+        if (!budget_) return true;
+        if (pending_ == batch_ && !refill()) return false;
+        pending_++;
+        return true;
+    }
+
+    // Releases the unused part of the current batch
+    void finish();
+
+private:
+    bool refill();
+
+    QueryBudget* budget_;
+    std::size_t pending_ = 0;
+    std::size_t batch_ = 0;
+};
 
 // Computes Term Frequency (TF)
 // freq   : number of occurrences of a term in a document
@@ -18,6 +83,7 @@ double computeIDF(int totalDocs, int docsWithTerm);
 
 // Ranks documents using TF-IDF with positional index
 // TF is derived as: positions.size()
+// With a budget, stops early and ranks what was scored so far
 std::vector<std::pair<int,double>> rankDocuments(
     const std::vector<std::string>& queryTokens,
     const std::unordered_map<
@@ -26,6 +92,35 @@ std::vector<std::pair<int,double>> rankDocuments(
     >& positionalIndex,
     const std::unordered_map<int,int>& docLength,
     int totalDocs,
+    int K,
+    QueryBudget* budget = nullptr
+);
+
+// Docid-sorted posting without positions (TF = freq)
+struct Posting {
+    int docID;
+    int freq;
+};
+
+// Ranks the documents of one docID range [docBegin, docEnd).
+// postingLists[i] holds the range's postings for query term i
+// (null if absent) and idfs[i] its corpus-wide IDF. Scores are
+// accumulated in a dense array and the range's Top-K kept in a
+// bounded min-heap. Postings outside the range are ignored.
+std::vector<std::pair<int,double>> rankDocumentRange(
+    const std::vector<const std::vector<Posting>*>& postingLists,
+    const std::vector<double>& idfs,
+    const std::unordered_map<int,int>& docLength,
+    int docBegin,
+    int docEnd,
+    int K,
+    QueryBudget* budget = nullptr
+);
+
+// Merges per-range Top-K lists into a global Top-K
+// (score descending, ties broken by higher docID like rankDocuments)
+std::vector<std::pair<int,double>> mergeTopK(
+    const std::vector<std::vector<std::pair<int,double>>>& partials,
     int K
 );
 
@@ -0,0 +1,220 @@
+#include "reorder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <numeric>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+/* ============================================================
+   PATH ORDER (NATURAL SORT)
+   ============================================================ */
+
+// Compares strings treating digit runs as numbers
+bool naturalLess(const string& a, const string& b) {
+    size_t i = 0, j = 0;
+
+    while (i < a.size() && j < b.size()) {
+        if (std::isdigit(static_cast<unsigned char>(a[i])) &&
+            std::isdigit(static_cast<unsigned char>(b[j]))) {
+            size_t i2 = i, j2 = j;
+            while (i2 < a.size() && std::isdigit(static_cast<unsigned char>(a[i2]))) i2++;
+            while (j2 < b.size() && std::isdigit(static_cast<unsigned char>(b[j2]))) j2++;
+
+            // Strip leading zeros, then compare by length and digits
+            size_t ia = i, jb = j;
+            while (ia + 1 < i2 && a[ia] == '0') ia++;
+            while (jb + 1 < j2 && b[jb] == '0') jb++;
+
+            if (i2 - ia != j2 - jb) return i2 - ia < j2 - jb;
+            int cmp = a.compare(ia, i2 - ia, b, jb, j2 - jb);
+            if (cmp != 0) return cmp < 0;
+
+            i = i2;
+            j = j2;
+        } else {
+            if (a[i] != b[j]) return a[i] < b[j];
+            i++;
+            j++;
+        }
+    }
+    return a.size() - i < b.size() - j;
+}
+
+/* ============================================================
+   RECURSIVE GRAPH BISECTION (BP)
+   ============================================================
+   Cost of a term in a half with n docs, deg of which contain it:
+       deg * log2(n / (deg + 1))
+   i.e. the approximate bits of its d-gaps. Each iteration
+   computes, for every doc, the cost saved by moving it to the
+   other half, then swaps the best pairs while the combined gain
+   stays positive.
+   ============================================================ */
+
+const int BP_MAX_ITERATIONS = 20;
+const int BP_MIN_PARTITION  = 16;
+
+class GraphBisection {
+public:
+    GraphBisection(vector<vector<int>> docTerms, int numTerms)
+        : docTerms_(std::move(docTerms)),
+          degLeft_(numTerms, 0),
+          degRight_(numTerms, 0),
+          gainToRight_(numTerms, 0.0),
+          gainToLeft_(numTerms, 0.0) {}
+
+    void run(vector<int>& order) {
+        bisect(order, 0, order.size());
+    }
+
+private:
+    static double cost(int deg, int n) {
+        return deg * std::log2(static_cast<double>(n) / (deg + 1));
+    }
+
+    void bisect(vector<int>& order, size_t begin, size_t end) {
+        size_t n = end - begin;
+        if (n <= static_cast<size_t>(BP_MIN_PARTITION)) return;
+
+        size_t mid = begin + n / 2;
+        int nLeft  = static_cast<int>(mid - begin);
+        int nRight = static_cast<int>(end - mid);
+
+        for (size_t i = begin; i < end; i++) {
+            auto& deg = i < mid ? degLeft_ : degRight_;
+            for (int t : docTerms_[order[i]]) deg[t]++;
+        }
+
+        vector<std::pair<double, int>> left, right;  // {gain, doc}
+
+        for (int iter = 0; iter < BP_MAX_ITERATIONS; iter++) {
+            // Per-term gain of moving one doc across, for terms in range
+            for (size_t i = begin; i < end; i++) {
+                for (int t : docTerms_[order[i]]) {
+                    int dl = degLeft_[t], dr = degRight_[t];
+                    double before = cost(dl, nLeft) + cost(dr, nRight);
+                    gainToRight_[t] = dl > 0
+                        ? before - cost(dl - 1, nLeft) - cost(dr + 1, nRight) : 0.0;
+                    gainToLeft_[t] = dr > 0
+                        ? before - cost(dl + 1, nLeft) - cost(dr - 1, nRight) : 0.0;
+                }
+            }
+
+            left.clear();
+            right.clear();
+            for (size_t i = begin; i < end; i++) {
+                int doc = order[i];
+                double gain = 0.0;
+                for (int t : docTerms_[doc]) {
+                    gain += i < mid ? gainToRight_[t] : gainToLeft_[t];
+                }
+                (i < mid ? left : right).emplace_back(gain, doc);
+            }
+
+            auto byGainDesc = [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+                return a.first > b.first;
+            };
+            std::sort(left.begin(), left.end(), byGainDesc);
+            std::sort(right.begin(), right.end(), byGainDesc);
+
+            size_t swaps = 0;
+            while (swaps < left.size() && swaps < right.size() &&
+                   left[swaps].first + right[swaps].first > 0.0) {
+                for (int t : docTerms_[left[swaps].second])  { degLeft_[t]--; degRight_[t]++; }
+                for (int t : docTerms_[right[swaps].second]) { degRight_[t]--; degLeft_[t]++; }
+                std::swap(left[swaps].second, right[swaps].second);
+                swaps++;
+            }
+
+            for (size_t i = 0; i < left.size(); i++)  order[begin + i] = left[i].second;
+            for (size_t i = 0; i < right.size(); i++) order[mid + i]   = right[i].second;
+
+            if (swaps == 0) break;
+        }
+
+        // Reset degree counters for the terms of this range
+        for (size_t i = begin; i < end; i++) {
+            for (int t : docTerms_[order[i]]) {
+                degLeft_[t] = 0;
+                degRight_[t] = 0;
+            }
+        }
+
+        bisect(order, begin, mid);
+        bisect(order, mid, end);
+    }
+
+    vector<vector<int>> docTerms_;
+    vector<int> degLeft_;
+    vector<int> degRight_;
+    vector<double> gainToRight_;
+    vector<double> gainToLeft_;
+};
+
+}  // namespace
+
+/* ============================================================
+   PUBLIC API
+   ============================================================ */
+
+bool parseReorderMethod(const string& name, ReorderMethod& method) {
+    if (name == "none") method = ReorderMethod::None;
+    else if (name == "path") method = ReorderMethod::Path;
+    else if (name == "bp") method = ReorderMethod::BP;
+    else return false;
+    return true;
+}
+
+vector<int> computeDocOrder(
+    ReorderMethod method,
+    const PositionalIndex& positionalIndex,
+    const std::unordered_map<int, string>& docIdToName,
+    int numDocs
+) {
+    vector<int> order(numDocs);
+    std::iota(order.begin(), order.end(), 0);
+
+    if (method == ReorderMethod::Path) {
+        std::stable_sort(order.begin(), order.end(), [&docIdToName](int a, int b) {
+            auto ia = docIdToName.find(a), ib = docIdToName.find(b);
+            if (ia == docIdToName.end() || ib == docIdToName.end()) return false;
+            return naturalLess(ia->second, ib->second);
+        });
+    } else if (method == ReorderMethod::BP) {
+        // Doc -> distinct term IDs; terms in a single doc never
+        // create a gap and are skipped
+        vector<vector<int>> docTerms(numDocs);
+        int numTerms = 0;
+
+        for (const auto& [word, docMap] : positionalIndex) {
+            if (docMap.size() < 2) continue;
+            for (const auto& docPair : docMap) {
+                if (docPair.first >= 0 && docPair.first < numDocs) {
+                    docTerms[docPair.first].push_back(numTerms);
+                }
+            }
+            numTerms++;
+        }
+
+        GraphBisection(std::move(docTerms), numTerms).run(order);
+    }
+
+    return order;
+}
+
+vector<Document> applyDocOrder(vector<Document> documents, const vector<int>& newToOld) {
+    vector<Document> reordered;
+    reordered.reserve(newToOld.size());
+
+    for (size_t newID = 0; newID < newToOld.size(); newID++) {
+        Document doc = std::move(documents[newToOld[newID]]);
+        doc.id = static_cast<int>(newID);
+        reordered.push_back(std::move(doc));
+    }
+    return reordered;
+}
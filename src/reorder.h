@@ -0,0 +1,48 @@
+#ifndef REORDER_H
+#define REORDER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "indexer.h"
+
+// ============================================================
+// Document reordering (docID reassignment)
+// ============================================================
+//
+// DocIDs normally follow directory iteration order, which is
+// arbitrary. Giving similar documents adjacent IDs shrinks d-gaps
+// (smaller varint postings) and clusters the docs a query touches.
+//
+// - path : natural sort of file paths ("doc2" < "doc10"). Cheap;
+//          works when paths encode locality (e.g. chunked books).
+// - bp   : recursive graph bisection. Splits the doc set in two,
+//          swaps docs between halves to minimize the log-gap cost
+//          of the term-document graph, then recurses.
+//
+enum class ReorderMethod {
+    None,
+    Path,
+    BP
+};
+
+// Parses "none" / "path" / "bp"
+bool parseReorderMethod(const std::string& name, ReorderMethod& method);
+
+// Returns newToOld: position i holds the old docID that becomes i.
+// The index must use docIDs 0..numDocs-1.
+std::vector<int> computeDocOrder(
+    ReorderMethod method,
+    const PositionalIndex& positionalIndex,
+    const std::unordered_map<int, std::string>& docIdToName,
+    int numDocs
+);
+
+// Permutes documents and renumbers Document::id to match
+std::vector<Document> applyDocOrder(
+    std::vector<Document> documents,
+    const std::vector<int>& newToOld
+);
+
+#endif
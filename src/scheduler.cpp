@@ -0,0 +1,300 @@
+#include "scheduler.h"
+
+#include <algorithm>
+
+#include "pruning.h"
+#include "query_shapes.h"
+#include "ranker.h"
+
+namespace {
+
+// Weight of the newest sample in the service-time EWMA
+const double SERVICE_TIME_ALPHA = 0.1;
+
+// Decrements the in-flight counter when a query leaves rank()
+struct InFlightGuard {
+    std::atomic<int>& counter;
+    int active;
+
+    explicit InFlightGuard(std::atomic<int>& c) : counter(c), active(++c) {}
+    ~InFlightGuard() { counter--; }
+};
+
+}  // namespace
+
+/* ============================================================
+   PARTITIONING (DOCID RANGES, FIRST-TOUCH ON HOME WORKER)
+   ============================================================ */
+
+void partitionSnapshot(IndexSnapshot& snapshot, WorkStealingPool& pool) {
+    int docLimit = snapshot.totalDocs;
+    for (const auto& entry : snapshot.docIdToName) {
+        docLimit = std::max(docLimit, entry.first + 1);
+    }
+
+    int numPartitions = static_cast<int>(
+        std::min<size_t>(pool.size(), std::max(1, docLimit))
+    );
+    int rangeSize = (docLimit + numPartitions - 1) / std::max(1, numPartitions);
+
+    snapshot.partitions.clear();
+    snapshot.partitions.resize(numPartitions);
+
+    /* ------------------------------------------------------------
+       1) ONE PASS: EACH TERM'S POSTINGS, DOCID-SORTED (ANY WORKER)
+       ------------------------------------------------------------ */
+    std::vector<const PositionalIndex::value_type*> terms;
+    terms.reserve(snapshot.positionalIndex.size());
+    for (const auto& entry : snapshot.positionalIndex) terms.push_back(&entry);
+
+    std::vector<std::vector<Posting>> sortedLists(terms.size());
+
+    const size_t numChunks = std::min<size_t>(pool.size(), std::max<size_t>(1, terms.size()));
+    const size_t chunkSize = (terms.size() + numChunks - 1) / numChunks;
+
+    TaskGroup flattened;
+    flattened.add(static_cast<int>(numChunks));
+
+    for (size_t c = 0; c < numChunks; c++) {
+        pool.submit(static_cast<unsigned int>(c), [&, c]() {
+            size_t last = std::min(terms.size(), (c + 1) * chunkSize);
+            for (size_t t = c * chunkSize; t < last; t++) {
+                std::vector<Posting>& list = sortedLists[t];
+                list.reserve(terms[t]->second.size());
+
+                for (const auto& [docID, positions] : terms[t]->second) {
+                    list.push_back({docID, static_cast<int>(positions.size())});
+                }
+                std::sort(list.begin(), list.end(),
+                          [](const Posting& a, const Posting& b) { return a.docID < b.docID; });
+            }
+            flattened.done();
+        });
+    }
+    flattened.wait();
+
+    /* ------------------------------------------------------------
+       2) EACH PARTITION COPIES ITS DOCID RANGE ON ITS HOME WORKER
+       ------------------------------------------------------------
+       Pinned: a stolen task would first-touch the partition on the
+       wrong node. Ranges are found by binary search, so the index
+       itself is traversed once whatever the number of partitions.
+       ------------------------------------------------------------ */
+    TaskGroup group;
+    group.add(numPartitions);
+
+    for (int p = 0; p < numPartitions; p++) {
+        IndexPartition& partition = snapshot.partitions[p];
+        partition.docBegin   = std::min(docLimit, p * rangeSize);
+        partition.docEnd     = std::min(docLimit, (p + 1) * rangeSize);
+        partition.homeWorker = static_cast<unsigned int>(p);
+
+        pool.submitPinned(partition.homeWorker, [&snapshot, &partition, &group, &terms, &sortedLists]() {
+            for (int docID = partition.docBegin; docID < partition.docEnd; docID++) {
+                auto lenIt = snapshot.docLength.find(docID);
+                partition.lengths.push_back(lenIt == snapshot.docLength.end() ? 0 : lenIt->second);
+            }
+
+            auto byDocID = [](const Posting& posting, int docID) { return posting.docID < docID; };
+            for (size_t t = 0; t < terms.size(); t++) {
+                const std::vector<Posting>& list = sortedLists[t];
+                auto first = std::lower_bound(list.begin(), list.end(), partition.docBegin, byDocID);
+                auto last  = std::lower_bound(first, list.end(), partition.docEnd, byDocID);
+                if (first == last) continue;
+
+                partition.postings.emplace(terms[t]->first, std::vector<Posting>(first, last));
+            }
+            group.done();
+        });
+    }
+
+    group.wait();
+}
+
+/* ============================================================
+   QUERY SCHEDULER
+   ============================================================ */
+
+QueryScheduler::QueryScheduler(unsigned int numWorkers, size_t minPostingsPerTask)
+    : pool_(numWorkers), minPostingsPerTask_(std::max<size_t>(1, minPostingsPerTask)) {}
+
+QueryScheduler::Stats QueryScheduler::stats() const {
+    Stats s;
+    s.serialQueries   = serialQueries_.load();
+    s.parallelQueries = parallelQueries_.load();
+    s.tasks           = tasks_.load();
+    s.tier1Answers    = tier1Answers_.load();
+    s.tier1Fallbacks  = tier1Fallbacks_.load();
+    return s;
+}
+
+int QueryScheduler::chooseDegree(size_t totalPostings, size_t numPartitions) const {
+    if (numPartitions <= 1) return 1;
+
+    // Workers available to this query under the current load
+    int active = std::max(1, inFlight_.load());
+    size_t share = std::max<size_t>(1, pool_.size() / active);
+
+    size_t byWork = totalPostings / minPostingsPerTask_;
+
+    return static_cast<int>(std::max<size_t>(1, std::min({numPartitions, share, byWork})));
+}
+
+std::vector<std::pair<int,double>> QueryScheduler::rank(
+    const IndexSnapshot& snapshot,
+    const std::vector<std::string>& queryTokens,
+    int K,
+    QueryBudget* budget
+) {
+    InFlightGuard guard(inFlight_);
+
+    // Bootstrap snapshot: postings come from the mmap'd segment.
+    // Corrupt postings fail the query (reported by TieredIndex).
+    if (snapshot.tiered && snapshot.positionalIndex.empty()) {
+        serialQueries_++;
+        std::vector<std::pair<int,double>> results;
+        snapshot.tiered->rank(
+            queryTokens, snapshot.docLength, snapshot.totalDocs, K, results, budget
+        );
+        return results;
+    }
+
+    if (!snapshot.prunedIndex.empty()) {
+        std::vector<std::pair<int,double>> results;
+        if (rankPruned(snapshot.prunedIndex, snapshot.positionalIndex, queryTokens,
+                       snapshot.docLength, snapshot.totalDocs, K, results, budget)) {
+            tier1Answers_++;
+            serialQueries_++;
+            return results;
+        }
+        tier1Fallbacks_++;
+    }
+
+    if (snapshot.partitions.empty()) {
+        serialQueries_++;
+        return rankDocuments(
+            queryTokens,
+            snapshot.positionalIndex,
+            snapshot.docLength,
+            snapshot.totalDocs,
+            K,
+            budget
+        );
+    }
+
+    // Corpus-wide IDF per term (shared by every range)
+    std::vector<double> idfs;
+    size_t totalPostings = 0;
+
+    for (const auto& token : queryTokens) {
+        auto it = snapshot.positionalIndex.find(token);
+        int docsWithTerm = it == snapshot.positionalIndex.end()
+            ? 0 : static_cast<int>(it->second.size());
+
+        idfs.push_back(computeIDF(snapshot.totalDocs, docsWithTerm));
+        totalPostings += docsWithTerm;
+    }
+
+    const size_t numPartitions = snapshot.partitions.size();
+    const int degree = chooseDegree(totalPostings, numPartitions);
+
+    std::vector<std::vector<std::pair<int,double>>> partials(degree);
+
+    // Group g scores partitions [g*P/degree, (g+1)*P/degree)
+    auto runGroup = [&](int g) {
+        size_t first = g * numPartitions / degree;
+        size_t last  = (g + 1) * numPartitions / degree;
+
+        std::vector<const std::vector<Posting>*> lists(queryTokens.size());
+
+        for (size_t p = first; p < last; p++) {
+            if (budget && budget->exhausted) break;
+
+            const IndexPartition& partition = snapshot.partitions[p];
+
+            for (size_t t = 0; t < queryTokens.size(); t++) {
+                auto it = partition.postings.find(queryTokens[t]);
+                lists[t] = it == partition.postings.end() ? nullptr : &it->second;
+            }
+
+            auto ranked = rankPartition(
+                partition, lists, idfs, snapshot.docLength, K, budget
+            );
+            partials[g] = mergeTopK({std::move(partials[g]), std::move(ranked)}, K);
+        }
+    };
+
+    if (degree == 1) {
+        serialQueries_++;
+        runGroup(0);
+        return std::move(partials[0]);
+    }
+
+    parallelQueries_++;
+    tasks_ += degree;
+
+    TaskGroup group;
+    group.add(degree - 1);
+
+    for (int g = 1; g < degree; g++) {
+        const IndexPartition& home = snapshot.partitions[g * numPartitions / degree];
+        pool_.submit(home.homeWorker, [&runGroup, &group, g]() {
+            runGroup(g);
+            group.done();
+        });
+    }
+
+    // The calling thread takes the first group instead of idling
+    runGroup(0);
+    group.wait();
+
+    return mergeTopK(partials, K);
+}
+
+/* ============================================================
+   ADMISSION CONTROL
+   ============================================================ */
+
+AdmissionController::AdmissionController(unsigned int maxConcurrent, std::chrono::microseconds slo)
+    : maxConcurrent_(std::max(1u, maxConcurrent)), slo_(slo) {}
+
+bool AdmissionController::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (running_ >= maxConcurrent_) {
+        // Everyone ahead of us, drained maxConcurrent_ at a time
+        double expectedWait = (waiting_ + 1) * avgServiceMicros_ / maxConcurrent_;
+
+        if (expectedWait > static_cast<double>(slo_.count())) {
+            stats_.shed++;
+            return false;
+        }
+
+        waiting_++;
+        stats_.queued++;
+        slotFree_.wait(lock, [this]() { return running_ < maxConcurrent_; });
+        waiting_--;
+    }
+
+    running_++;
+    stats_.admitted++;
+    return true;
+}
+
+void AdmissionController::release(std::chrono::microseconds serviceTime) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_--;
+
+        double sample = static_cast<double>(serviceTime.count());
+        avgServiceMicros_ = avgServiceMicros_ == 0.0
+            ? sample
+            : (1.0 - SERVICE_TIME_ALPHA) * avgServiceMicros_ + SERVICE_TIME_ALPHA * sample;
+    }
+    slotFree_.notify_one();
+}
+
+AdmissionController::Stats AdmissionController::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
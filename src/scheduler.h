@@ -0,0 +1,126 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ranker.h"
+#include "snapshot.h"
+#include "thread_pool.h"
+
+// Splits a snapshot into one docID-range partition per pool
+// worker. The index is traversed once into docID-sorted lists;
+// each partition then copies its range on its home worker.
+void partitionSnapshot(IndexSnapshot& snapshot, WorkStealingPool& pool);
+
+// ============================================================
+// Query scheduler (inter- vs intra-query parallelism)
+// ============================================================
+//
+// - Light load: a heavy query is split into docID-range tasks on
+//   the work-stealing pool; the calling thread scores one group
+//   itself and the per-range Top-K heaps are merged.
+// - Heavy load: every worker already has a query of its own, so
+//   splitting only adds overhead; queries run serially on the
+//   calling thread (inter-query parallelism).
+// - Small queries (few postings) are never split.
+// - With a pruned tier (see pruning.h) a query is first tried on
+//   it and only falls back to the full index when the tier-1
+//   answer cannot be certified.
+//
+class QueryScheduler {
+public:
+    struct Stats {
+        unsigned long long serialQueries = 0;
+        unsigned long long parallelQueries = 0;
+        unsigned long long tasks = 0;
+        unsigned long long tier1Answers = 0;    // certified from the pruned tier
+        unsigned long long tier1Fallbacks = 0;  // pruned tier tried, full index used
+    };
+
+    // Below this many postings per task, fork/join overhead dominates
+    static constexpr size_t DEFAULT_MIN_POSTINGS_PER_TASK = 16384;
+
+    // A query is split into at most totalPostings / minPostingsPerTask tasks
+    explicit QueryScheduler(
+        unsigned int numWorkers,
+        size_t minPostingsPerTask = DEFAULT_MIN_POSTINGS_PER_TASK
+    );
+
+    WorkStealingPool& pool() { return pool_; }
+
+    // TF-IDF Top-K over the snapshot; same results as rankDocuments.
+    // The budget (optional) is shared by every task of the query;
+    // when it runs out the partial Top-K is returned.
+    std::vector<std::pair<int,double>> rank(
+        const IndexSnapshot& snapshot,
+        const std::vector<std::string>& queryTokens,
+        int K,
+        QueryBudget* budget = nullptr
+    );
+
+    Stats stats() const;
+
+private:
+    // Number of tasks to split a query with totalPostings into
+    int chooseDegree(size_t totalPostings, size_t numPartitions) const;
+
+    WorkStealingPool pool_;
+    const size_t minPostingsPerTask_;
+    std::atomic<int> inFlight_{0};
+
+    std::atomic<unsigned long long> serialQueries_{0};
+    std::atomic<unsigned long long> parallelQueries_{0};
+    std::atomic<unsigned long long> tasks_{0};
+    std::atomic<unsigned long long> tier1Answers_{0};
+    std::atomic<unsigned long long> tier1Fallbacks_{0};
+};
+
+// ============================================================
+// Admission control (load shedding)
+// ============================================================
+//
+// At most maxConcurrent queries execute at once; the rest wait.
+// The expected wait is estimated from the number of queued
+// queries and an EWMA of recent service times. A query whose
+// expected wait already exceeds the SLO is rejected on arrival
+// instead of being queued: under overload the admitted queries
+// keep meeting the SLO rather than every query missing it.
+//
+class AdmissionController {
+public:
+    struct Stats {
+        unsigned long long admitted = 0;
+        unsigned long long shed = 0;
+        unsigned long long queued = 0;  // admitted after waiting
+    };
+
+    AdmissionController(unsigned int maxConcurrent, std::chrono::microseconds slo);
+
+    // Blocks until a slot is free; false if the query is shed
+    bool acquire();
+
+    // Frees the slot and feeds the measured service time to the EWMA
+    void release(std::chrono::microseconds serviceTime);
+
+    Stats stats() const;
+
+private:
+    const unsigned int maxConcurrent_;
+    const std::chrono::microseconds slo_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable slotFree_;
+    unsigned int running_ = 0;
+    unsigned int waiting_ = 0;
+    double avgServiceMicros_ = 0.0;
+
+    Stats stats_;
+};
+
+#endif
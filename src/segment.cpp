@@ -0,0 +1,946 @@
+#include "segment.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+const char SEGMENT_MAGIC[4]   = {'I', 'S', 'E', 'G'};
+const char DOCTABLE_MAGIC[4]  = {'I', 'D', 'O', 'C'};
+
+// Version 2 appends the term directory; version 1 is still read
+const uint32_t SEGMENT_VERSION        = 2;
+const uint32_t LEGACY_SEGMENT_VERSION = 1;
+const uint32_t DOCTABLE_VERSION       = 1;
+
+// Runs merged per pass; keeps open file handles bounded
+const std::size_t MAX_MERGE_FAN_IN = 64;
+
+/* ============================================================
+   VARINT ENCODING (LEB128)
+   ============================================================ */
+
+void writeVarint(std::ostream& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+std::size_t varintSize(uint64_t value) {
+    std::size_t bytes = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        bytes++;
+    }
+    return bytes;
+}
+
+bool readVarint(std::istream& in, uint64_t& value) {
+    value = 0;
+    int shift = 0;
+    int ch;
+
+    while ((ch = in.get()) != std::char_traits<char>::eof()) {
+        value |= static_cast<uint64_t>(ch & 0x7F) << shift;
+        if (!(ch & 0x80)) return true;
+        shift += 7;
+        if (shift > 63) return false;
+    }
+    return false;
+}
+
+bool readHeader(std::istream& in, const char magic[4], uint32_t& version) {
+    char buf[4];
+    version = 0;
+
+    in.read(buf, 4);
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+
+    return in && std::memcmp(buf, magic, 4) == 0;
+}
+
+void writeHeader(std::ostream& out, const char magic[4], uint32_t version) {
+    out.write(magic, 4);
+    out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+}
+
+/* ============================================================
+   SEGMENT WRITER
+   ============================================================
+   Terms must be added in sorted order. Postings of one term may
+   be appended in several calls (e.g. one per merged run) as long
+   as docIDs keep increasing; gaps are computed across calls.
+   ============================================================ */
+
+class SegmentWriter {
+public:
+    explicit SegmentWriter(const string& filename)
+        : out_(filename, std::ios::binary) {
+        writeHeader(out_, SEGMENT_MAGIC, SEGMENT_VERSION);
+        countPos_ = out_.tellp();
+        uint64_t placeholder = 0;
+        out_.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+        bytes_ = SEGMENT_HEADER_BYTES;
+    }
+
+    bool ok() const { return static_cast<bool>(out_); }
+
+    void beginTerm(const string& term, uint64_t docCount) {
+        endTerm();
+
+        put(term.size());
+        out_.write(term.data(), term.size());
+        bytes_ += term.size();
+        put(docCount);
+
+        SegmentTermEntry entry;
+        entry.term = term;
+        entry.offset = bytes_;
+        entry.docCount = static_cast<int>(docCount);
+        directory_.push_back(std::move(entry));
+
+        prevDoc_ = 0;
+        termCount_++;
+    }
+
+    void addDoc(int docID, const vector<int>& positions) {
+        put(static_cast<uint64_t>(docID - prevDoc_));
+        prevDoc_ = docID;
+        directory_.back().lastDocID = docID;
+
+        put(positions.size());
+        int prevPos = 0;
+        for (int pos : positions) {
+            put(static_cast<uint64_t>(pos - prevPos));
+            prevPos = pos;
+        }
+    }
+
+    // Appends the term directory and footer, then patches the term
+    // count into the header
+    bool finish() {
+        endTerm();
+
+        // Front-coded against the previous term; offsets relative
+        // to the previous term's end
+        const uint64_t directoryOffset = bytes_;
+        const string* prevTerm = nullptr;
+        std::size_t prevEnd = 0;
+
+        for (const auto& entry : directory_) {
+            std::size_t shared = 0;
+            if (prevTerm) {
+                std::size_t limit = std::min(prevTerm->size(), entry.term.size());
+                while (shared < limit && (*prevTerm)[shared] == entry.term[shared]) shared++;
+            }
+            put(shared);
+            put(entry.term.size() - shared);
+            out_.write(entry.term.data() + shared, entry.term.size() - shared);
+
+            put(entry.offset - prevEnd);
+            put(entry.end - entry.offset);
+            put(static_cast<uint64_t>(entry.docCount));
+            put(static_cast<uint64_t>(entry.lastDocID + 1));
+
+            prevTerm = &entry.term;
+            prevEnd = entry.end;
+        }
+        out_.write(reinterpret_cast<const char*>(&directoryOffset), sizeof(directoryOffset));
+
+        out_.seekp(countPos_);
+        out_.write(reinterpret_cast<const char*>(&termCount_), sizeof(termCount_));
+        out_.close();
+        return !out_.fail();
+    }
+
+    uint64_t termCount() const { return termCount_; }
+
+private:
+    void put(uint64_t value) {
+        writeVarint(out_, value);
+        bytes_ += varintSize(value);
+    }
+
+    void endTerm() {
+        if (!directory_.empty() && directory_.back().end == 0) {
+            directory_.back().end = bytes_;
+        }
+    }
+
+    std::ofstream out_;
+    std::streampos countPos_;
+    std::size_t bytes_ = 0;  // offset of the next byte written
+    vector<SegmentTermEntry> directory_;
+    uint64_t termCount_ = 0;
+    int prevDoc_ = 0;
+};
+
+/* ============================================================
+   SEGMENT READER (STREAMING)
+   ============================================================
+   Usage: nextTerm(), then exactly docCount calls to nextDoc(),
+   then nextTerm() again. Only one document's positions are held
+   in memory at a time.
+   ============================================================ */
+
+class SegmentReader {
+public:
+    explicit SegmentReader(const string& filename)
+        : in_(filename, std::ios::binary) {
+        uint32_t version = 0;
+        if (!readHeader(in_, SEGMENT_MAGIC, version) ||
+            (version != SEGMENT_VERSION && version != LEGACY_SEGMENT_VERSION)) {
+            valid_ = false;
+            return;
+        }
+        in_.read(reinterpret_cast<char*>(&termsLeft_), sizeof(termsLeft_));
+        valid_ = static_cast<bool>(in_);
+    }
+
+    bool valid() const { return valid_; }
+
+    bool nextTerm(string& term, uint64_t& docCount) {
+        if (!valid_ || termsLeft_ == 0) return false;
+
+        uint64_t len = 0;
+        if (!readVarint(in_, len)) return fail();
+        term.resize(len);
+        in_.read(&term[0], len);
+        if (!readVarint(in_, docCount)) return fail();
+
+        termsLeft_--;
+        prevDoc_ = 0;
+        return true;
+    }
+
+    bool nextDoc(int& docID, vector<int>& positions) {
+        uint64_t gap = 0, count = 0;
+        if (!readVarint(in_, gap) || !readVarint(in_, count)) return fail();
+
+        prevDoc_ += static_cast<int>(gap);
+        docID = prevDoc_;
+
+        positions.resize(count);
+        int pos = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            if (!readVarint(in_, gap)) return fail();
+            pos += static_cast<int>(gap);
+            positions[i] = pos;
+        }
+        return true;
+    }
+
+private:
+    bool fail() {
+        valid_ = false;
+        return false;
+    }
+
+    std::ifstream in_;
+    uint64_t termsLeft_ = 0;
+    int prevDoc_ = 0;
+    bool valid_ = true;
+};
+
+/* ============================================================
+   K-WAY MERGE OF SORTED RUNS
+   ============================================================
+   Runs are ordered by the docIDs they cover (run i only holds
+   docs smaller than any doc in run i+1), so postings of a term
+   that appears in several runs are concatenated in run order.
+   ============================================================ */
+
+struct RunCursor {
+    std::unique_ptr<SegmentReader> reader;
+    string term;
+    uint64_t docCount = 0;
+    bool done = false;
+
+    void advance() {
+        done = !reader->nextTerm(term, docCount);
+    }
+};
+
+bool mergeRuns(const vector<string>& runs, const string& outFile, uint64_t& termCount) {
+    vector<RunCursor> cursors(runs.size());
+    for (size_t i = 0; i < runs.size(); i++) {
+        cursors[i].reader = std::make_unique<SegmentReader>(runs[i]);
+        if (!cursors[i].reader->valid()) {
+            std::cerr << "Error: Corrupt run file " << runs[i] << "\n";
+            return false;
+        }
+        cursors[i].advance();
+    }
+
+    // Min-heap on (term, run index)
+    auto cmp = [&cursors](size_t a, size_t b) {
+        if (cursors[a].term != cursors[b].term) {
+            return cursors[a].term > cursors[b].term;
+        }
+        return a > b;
+    };
+    std::priority_queue<size_t, vector<size_t>, decltype(cmp)> heap(cmp);
+
+    for (size_t i = 0; i < cursors.size(); i++) {
+        if (!cursors[i].done) heap.push(i);
+    }
+
+    SegmentWriter writer(outFile);
+    if (!writer.ok()) {
+        std::cerr << "Error: Unable to open " << outFile << " for writing\n";
+        return false;
+    }
+
+    vector<size_t> group;
+    vector<int> positions;
+
+    while (!heap.empty()) {
+        group.clear();
+        group.push_back(heap.top());
+        heap.pop();
+
+        const string term = cursors[group[0]].term;
+        while (!heap.empty() && cursors[heap.top()].term == term) {
+            group.push_back(heap.top());
+            heap.pop();
+        }
+
+        uint64_t totalDocs = 0;
+        for (size_t idx : group) totalDocs += cursors[idx].docCount;
+
+        // Heap order already yields ascending run index within a term
+        writer.beginTerm(term, totalDocs);
+        for (size_t idx : group) {
+            for (uint64_t d = 0; d < cursors[idx].docCount; d++) {
+                int docID;
+                if (!cursors[idx].reader->nextDoc(docID, positions)) {
+                    std::cerr << "Error: Truncated run file " << runs[idx] << "\n";
+                    return false;
+                }
+                writer.addDoc(docID, positions);
+            }
+            cursors[idx].advance();
+            if (!cursors[idx].done) heap.push(idx);
+        }
+    }
+
+    termCount = writer.termCount();
+    return writer.finish();
+}
+
+/* ============================================================
+   RUN SPILLING
+   ============================================================ */
+
+bool writeSortedRun(const string& filename, const PositionalIndex& batch) {
+    SegmentWriter writer(filename);
+    if (!writer.ok()) return false;
+
+    vector<const PositionalIndex::value_type*> terms;
+    terms.reserve(batch.size());
+    for (const auto& entry : batch) terms.push_back(&entry);
+
+    std::sort(terms.begin(), terms.end(),
+              [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    vector<int> docIDs;
+    for (const auto* entry : terms) {
+        const auto& docMap = entry->second;
+
+        docIDs.clear();
+        for (const auto& docPair : docMap) docIDs.push_back(docPair.first);
+        std::sort(docIDs.begin(), docIDs.end());
+
+        writer.beginTerm(entry->first, docIDs.size());
+        for (int docID : docIDs) {
+            writer.addDoc(docID, docMap.at(docID));
+        }
+    }
+    return writer.finish();
+}
+
+/*
+ Approximate heap cost of batch entries, used to decide when to
+ spill. Constants cover node, bucket and vector headers on 64-bit
+ libstdc++/libc++; positions are counted at 2x for vector slack.
+*/
+const std::size_t TERM_OVERHEAD_BYTES    = 96;
+const std::size_t POSTING_OVERHEAD_BYTES = 64;
+const std::size_t POSITION_BYTES         = 2 * sizeof(int);
+
+}  // namespace
+
+/* ============================================================
+   PUBLIC API
+   ============================================================ */
+
+bool writeSegment(const string& filename, const PositionalIndex& positionalIndex) {
+    return writeSortedRun(filename, positionalIndex);
+}
+
+bool loadSegment(const string& filename, PositionalIndex& positionalIndex) {
+    SegmentReader reader(filename);
+    if (!reader.valid()) return false;
+
+    positionalIndex.clear();
+
+    string term;
+    uint64_t docCount = 0;
+    vector<int> positions;
+
+    while (reader.nextTerm(term, docCount)) {
+        auto& docMap = positionalIndex[term];
+        docMap.reserve(docCount);
+
+        for (uint64_t d = 0; d < docCount; d++) {
+            int docID;
+            if (!reader.nextDoc(docID, positions)) return false;
+            docMap[docID] = positions;
+        }
+    }
+    return reader.valid();
+}
+
+/* ============================================================
+   IN-MEMORY SEGMENT IMAGES
+   ============================================================ */
+
+const std::size_t SEGMENT_HEADER_BYTES = 4 + sizeof(uint32_t) + sizeof(uint64_t);
+
+bool decodeVarint(const unsigned char* data, std::size_t size, std::size_t& offset, uint64_t& value) {
+    value = 0;
+    int shift = 0;
+
+    while (offset < size) {
+        unsigned char byte = data[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+        shift += 7;
+        if (shift > 63) return false;
+    }
+    return false;
+}
+
+namespace {
+
+// Version-1 segments carry no directory: decode every posting to
+// find where each term ends
+bool scanSegmentTerms(
+    const unsigned char* data,
+    std::size_t size,
+    uint64_t termCount,
+    vector<SegmentTermEntry>& terms
+) {
+    terms.clear();
+    terms.reserve(std::min<uint64_t>(termCount, size));
+
+    std::size_t offset = SEGMENT_HEADER_BYTES;
+    uint64_t termLen = 0, docCount = 0, gap = 0, posCount = 0;
+
+    for (uint64_t t = 0; t < termCount; t++) {
+        if (!decodeVarint(data, size, offset, termLen) || termLen > size - offset) return false;
+
+        SegmentTermEntry entry;
+        entry.term.assign(reinterpret_cast<const char*>(data + offset), termLen);
+        offset += termLen;
+
+        if (!decodeVarint(data, size, offset, docCount)) return false;
+        entry.offset = offset;
+        entry.docCount = static_cast<int>(docCount);
+
+        // Skip the postings; only the last docID is kept
+        int64_t docID = 0;
+        for (uint64_t d = 0; d < docCount; d++) {
+            if (!decodeVarint(data, size, offset, gap) ||
+                !decodeVarint(data, size, offset, posCount) ||
+                gap > static_cast<uint64_t>(std::numeric_limits<int>::max() - docID)) {
+                return false;
+            }
+            docID += static_cast<int64_t>(gap);
+            for (uint64_t p = 0; p < posCount; p++) {
+                if (!decodeVarint(data, size, offset, gap)) return false;
+            }
+        }
+        entry.lastDocID = docCount ? static_cast<int>(docID) : -1;
+        entry.end = offset;
+
+        terms.push_back(std::move(entry));
+    }
+    return true;
+}
+
+// Version 2: read the directory through the footer without
+// touching any posting bytes
+bool readPersistedDirectory(
+    const unsigned char* data,
+    std::size_t size,
+    uint64_t termCount,
+    vector<SegmentTermEntry>& terms
+) {
+    uint64_t directoryOffset = 0;
+    if (size < SEGMENT_HEADER_BYTES + sizeof(directoryOffset)) return false;
+
+    const std::size_t footer = size - sizeof(directoryOffset);
+    std::memcpy(&directoryOffset, data + footer, sizeof(directoryOffset));
+    if (directoryOffset < SEGMENT_HEADER_BYTES || directoryOffset > footer) return false;
+
+    terms.clear();
+    terms.reserve(std::min<uint64_t>(termCount, footer - directoryOffset));
+
+    std::size_t offset = directoryOffset;
+    std::size_t prevEnd = 0;
+    uint64_t shared = 0, suffixLen = 0, gap = 0, length = 0, docCount = 0, lastDoc = 0;
+
+    for (uint64_t t = 0; t < termCount; t++) {
+        if (!decodeVarint(data, footer, offset, shared) ||
+            !decodeVarint(data, footer, offset, suffixLen) ||
+            suffixLen > footer - offset) {
+            return false;
+        }
+
+        SegmentTermEntry entry;
+        if (shared > 0) {
+            if (terms.empty() || shared > terms.back().term.size()) return false;
+            entry.term.assign(terms.back().term, 0, shared);
+        }
+        entry.term.append(reinterpret_cast<const char*>(data + offset), suffixLen);
+        offset += suffixLen;
+
+        if (!decodeVarint(data, footer, offset, gap) ||
+            !decodeVarint(data, footer, offset, length) ||
+            !decodeVarint(data, footer, offset, docCount) ||
+            !decodeVarint(data, footer, offset, lastDoc)) {
+            return false;
+        }
+
+        // Postings must lie before the directory; a doc takes >= 2 bytes
+        if (gap > directoryOffset - prevEnd) return false;
+        const std::size_t start = prevEnd + gap;
+        if (start < SEGMENT_HEADER_BYTES || length > directoryOffset - start || docCount > length / 2 ||
+            lastDoc > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+            return false;
+        }
+
+        entry.offset = start;
+        entry.end = start + length;
+        entry.docCount = static_cast<int>(docCount);
+        entry.lastDocID = static_cast<int>(lastDoc) - 1;
+        prevEnd = entry.end;
+
+        terms.push_back(std::move(entry));
+    }
+    return true;
+}
+
+}  // namespace
+
+bool readSegmentDirectory(
+    const unsigned char* data,
+    std::size_t size,
+    vector<SegmentTermEntry>& terms
+) {
+    uint32_t version = 0;
+    uint64_t termCount = 0;
+
+    if (size < SEGMENT_HEADER_BYTES || std::memcmp(data, SEGMENT_MAGIC, 4) != 0) return false;
+    std::memcpy(&version, data + 4, sizeof(version));
+    std::memcpy(&termCount, data + 8, sizeof(termCount));
+
+    if (version == SEGMENT_VERSION) return readPersistedDirectory(data, size, termCount, terms);
+    if (version == LEGACY_SEGMENT_VERSION) return scanSegmentTerms(data, size, termCount, terms);
+    return false;
+}
+
+bool loadSegmentParallel(
+    const string& filename,
+    unsigned int numThreads,
+    PositionalIndex& positionalIndex
+) {
+    /* ------------------------------------------------------------
+       1) ONE SEQUENTIAL READ + TERM DIRECTORY
+       ------------------------------------------------------------ */
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+
+    vector<unsigned char> image(static_cast<std::size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(image.data()), image.size());
+    if (!in) return false;
+
+    vector<SegmentTermEntry> terms;
+    if (!readSegmentDirectory(image.data(), image.size(), terms)) return false;
+
+    /* ------------------------------------------------------------
+       2) CREATE EVERY KEY UP FRONT
+       ------------------------------------------------------------
+       The outer map is not modified once the workers start, so
+       each worker can fill its own doc maps without locking.
+       ------------------------------------------------------------ */
+    positionalIndex.clear();
+    positionalIndex.reserve(terms.size());
+
+    using DocMap = std::unordered_map<int, vector<int>>;
+    vector<DocMap*> slots(terms.size());
+    for (std::size_t t = 0; t < terms.size(); t++) {
+        slots[t] = &positionalIndex[terms[t].term];
+    }
+
+    /* ------------------------------------------------------------
+       3) DECODE TERM RANGES IN PARALLEL (BALANCED BY BYTES)
+       ------------------------------------------------------------ */
+    numThreads = std::max(1u, std::min<unsigned int>(numThreads, static_cast<unsigned int>(terms.size())));
+    const std::size_t postingBytes = terms.empty() ? 0 : terms.back().end - SEGMENT_HEADER_BYTES;
+    const std::size_t bytesPerThread = postingBytes / numThreads + 1;
+
+    vector<std::size_t> bounds{0};
+    for (std::size_t t = 0; t < terms.size() && bounds.size() < numThreads; t++) {
+        if (terms[t].end - SEGMENT_HEADER_BYTES >= bounds.size() * bytesPerThread) {
+            bounds.push_back(t + 1);
+        }
+    }
+    bounds.push_back(terms.size());
+
+    std::atomic<bool> ok{true};
+    auto decodeRange = [&](std::size_t first, std::size_t last) {
+        const unsigned char* data = image.data();
+        uint64_t gap = 0, posCount = 0;
+
+        for (std::size_t t = first; t < last && ok; t++) {
+            DocMap& docMap = *slots[t];
+            docMap.reserve(terms[t].docCount);
+
+            std::size_t offset = terms[t].offset;
+            int docID = 0;
+
+            for (int d = 0; d < terms[t].docCount && ok; d++) {
+                // Each position takes at least one byte: a larger count is corrupt
+                if (!decodeVarint(data, terms[t].end, offset, gap) ||
+                    !decodeVarint(data, terms[t].end, offset, posCount) ||
+                    posCount > terms[t].end - offset) {
+                    ok = false;
+                    break;
+                }
+                docID += static_cast<int>(gap);
+
+                vector<int>& positions = docMap[docID];
+                positions.resize(posCount);
+
+                int pos = 0;
+                for (uint64_t p = 0; p < posCount; p++) {
+                    if (!decodeVarint(data, terms[t].end, offset, gap)) {
+                        ok = false;
+                        break;
+                    }
+                    pos += static_cast<int>(gap);
+                    positions[p] = pos;
+                }
+            }
+        }
+    };
+
+    vector<std::thread> workers;
+    for (std::size_t r = 1; r + 1 < bounds.size(); r++) {
+        workers.emplace_back(decodeRange, bounds[r], bounds[r + 1]);
+    }
+    decodeRange(bounds[0], bounds[1]);  // calling thread takes the first range
+    for (auto& w : workers) w.join();
+
+    return ok;
+}
+
+bool writeDocTable(
+    const string& filename,
+    const std::unordered_map<int, string>& docIdToName,
+    const std::unordered_map<int, int>& docLength
+) {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) return false;
+
+    writeHeader(out, DOCTABLE_MAGIC, DOCTABLE_VERSION);
+
+    vector<int> docIDs;
+    docIDs.reserve(docIdToName.size());
+    for (const auto& entry : docIdToName) docIDs.push_back(entry.first);
+    std::sort(docIDs.begin(), docIDs.end());
+
+    for (int docID : docIDs) {
+        const string& path = docIdToName.at(docID);
+        auto lenIt = docLength.find(docID);
+
+        writeVarint(out, docID);
+        writeVarint(out, lenIt == docLength.end() ? 0 : lenIt->second);
+        writeVarint(out, path.size());
+        out.write(path.data(), path.size());
+    }
+    return static_cast<bool>(out);
+}
+
+bool loadDocTable(
+    const string& filename,
+    std::unordered_map<int, string>& docIdToName,
+    std::unordered_map<int, int>& docLength
+) {
+    std::ifstream in(filename, std::ios::binary);
+    uint32_t version = 0;
+    if (!in || !readHeader(in, DOCTABLE_MAGIC, version) || version != DOCTABLE_VERSION) return false;
+
+    docIdToName.clear();
+    docLength.clear();
+
+    uint64_t docID, length, pathLen;
+    string path;
+
+    while (in.peek() != std::char_traits<char>::eof()) {
+        if (!readVarint(in, docID) ||
+            !readVarint(in, length) ||
+            !readVarint(in, pathLen)) {
+            return false;
+        }
+        path.resize(pathLen);
+        in.read(&path[0], pathLen);
+        if (!in) return false;
+
+        docIdToName[static_cast<int>(docID)] = path;
+        docLength[static_cast<int>(docID)] = static_cast<int>(length);
+    }
+    return true;
+}
+
+bool buildSegmentStreaming(
+    const string& dataDir,
+    const string& segmentFile,
+    const StreamBuildOptions& options,
+    StreamBuildStats& stats
+) {
+    stats = StreamBuildStats();
+    auto start = std::chrono::high_resolution_clock::now();
+
+    fs::path runDir = options.runDir.empty()
+        ? fs::path(segmentFile + ".runs")
+        : fs::path(options.runDir);
+
+    std::error_code ec;
+    fs::create_directories(runDir, ec);
+    if (ec) {
+        std::cerr << "Error: Unable to create run directory " << runDir.string()
+                  << ": " << ec.message() << "\n";
+        return false;
+    }
+
+    fs::directory_iterator files(dataDir, ec);
+    if (ec) {
+        std::cerr << "Error: Unable to read " << dataDir << ": " << ec.message() << "\n";
+        fs::remove_all(runDir, ec);
+        return false;
+    }
+
+    std::ofstream docTable(segmentFile + ".docs", std::ios::binary);
+    if (!docTable) {
+        std::cerr << "Error: Unable to open doc table for writing\n";
+        fs::remove_all(runDir, ec);
+        return false;
+    }
+    writeHeader(docTable, DOCTABLE_MAGIC, DOCTABLE_VERSION);
+
+    vector<string> runs;
+    PositionalIndex batch;
+    std::size_t batchBytes = 0;
+
+    // False if the run could not be written (it is not kept)
+    auto spill = [&]() {
+        if (batch.empty()) return true;
+        string runFile = (runDir / ("run-" + std::to_string(runs.size()) + ".seg")).string();
+        if (!writeSortedRun(runFile, batch)) {
+            std::cerr << "Error: Unable to write run " << runFile << "\n";
+            return false;
+        }
+        runs.push_back(runFile);
+
+        // Swap with an empty map so bucket arrays are released too
+        PositionalIndex().swap(batch);
+        batchBytes = 0;
+        return true;
+    };
+
+    // Leaves the runs for inspection and reports where they are
+    auto fail = [&runDir](const string& what) {
+        std::cerr << "Error: " << what << "; runs kept in " << runDir.string() << "\n";
+        return false;
+    };
+
+    // Drops a half-written merge output (never a device or directory)
+    auto discard = [&ec](const string& file) {
+        if (fs::is_regular_file(file, ec)) fs::remove(file, ec);
+    };
+
+    /* ------------------------------------------------------------
+       1) TOKENIZE ONE DOCUMENT AT A TIME, SPILL ON BUDGET
+       ------------------------------------------------------------ */
+    int docID = 0;
+    string content;
+
+    for (const auto& entry : files) {
+        if (!entry.is_regular_file()) continue;
+
+        std::ifstream file(entry.path(), std::ios::binary);
+        if (!file.is_open()) continue;
+
+        content.assign(
+            (std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>()
+        );
+        stats.bytesRead += content.size();
+
+        int position = 0;
+        for (const auto& token : tokenize(content)) {
+            if (stopWords.count(token)) continue;
+
+            auto termIt = batch.find(token);
+            if (termIt == batch.end()) {
+                termIt = batch.emplace(token, std::unordered_map<int, vector<int>>()).first;
+                batchBytes += TERM_OVERHEAD_BYTES + token.size();
+            }
+
+            auto& positions = termIt->second[docID];
+            if (positions.empty()) batchBytes += POSTING_OVERHEAD_BYTES;
+
+            positions.push_back(position);
+            batchBytes += POSITION_BYTES;
+            position++;
+        }
+
+        const string path = entry.path().string();
+        writeVarint(docTable, docID);
+        writeVarint(docTable, position);
+        writeVarint(docTable, path.size());
+        docTable.write(path.data(), path.size());
+
+        stats.tokens += position;
+        stats.docs++;
+        docID++;
+
+        if (batchBytes >= options.memoryBudgetBytes && !spill()) return fail("spill failed");
+    }
+    if (!spill()) return fail("spill failed");
+
+    docTable.close();
+    if (docTable.fail()) return fail("unable to write " + segmentFile + ".docs");
+
+    stats.runs = runs.size();
+
+    /* ------------------------------------------------------------
+       2) MULTI-PASS K-WAY MERGE (BOUNDED FAN-IN)
+       ------------------------------------------------------------ */
+    uint64_t termCount = 0;
+    int pass = 0;
+
+    while (runs.size() > MAX_MERGE_FAN_IN) {
+        vector<string> next;
+        for (size_t i = 0; i < runs.size(); i += MAX_MERGE_FAN_IN) {
+            vector<string> group(
+                runs.begin() + i,
+                runs.begin() + std::min(runs.size(), i + MAX_MERGE_FAN_IN)
+            );
+            string out = (runDir / ("pass" + std::to_string(pass) + "-" +
+                                    std::to_string(next.size()) + ".seg")).string();
+            if (!mergeRuns(group, out, termCount)) {
+                discard(out);
+                return fail("merge pass " + std::to_string(pass) + " failed");
+            }
+
+            // Inputs are only dropped once their merged output is complete
+            for (const auto& run : group) fs::remove(run, ec);
+            next.push_back(out);
+        }
+        runs.swap(next);
+        pass++;
+    }
+
+    bool merged = runs.empty()
+        ? SegmentWriter(segmentFile).finish()
+        : mergeRuns(runs, segmentFile, termCount);
+    if (!merged) {
+        discard(segmentFile);
+        return fail("final merge into " + segmentFile + " failed");
+    }
+
+    fs::remove_all(runDir, ec);
+
+    stats.terms = termCount;
+    stats.segmentBytes = fs::exists(segmentFile) ? fs::file_size(segmentFile) : 0;
+    stats.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start
+    ).count();
+    stats.peakRssKb = peakRssKb();
+
+    return true;
+}
+
+PostingSizeStats measurePostingSize(const PositionalIndex& positionalIndex) {
+    PostingSizeStats stats;
+    vector<int> docIDs;
+
+    for (const auto& [word, docMap] : positionalIndex) {
+        docIDs.clear();
+        for (const auto& docPair : docMap) docIDs.push_back(docPair.first);
+        std::sort(docIDs.begin(), docIDs.end());
+
+        int prevDoc = 0;
+        for (int docID : docIDs) {
+            const vector<int>& positions = docMap.at(docID);
+
+            stats.docBytes += varintSize(docID - prevDoc) + varintSize(positions.size());
+            prevDoc = docID;
+
+            int prevPos = 0;
+            for (int pos : positions) {
+                stats.positionBytes += varintSize(pos - prevPos);
+                prevPos = pos;
+            }
+            stats.postings++;
+        }
+    }
+    return stats;
+}
+
+long peakRssKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+    return usage.ru_maxrss;         // KiB on Linux
+#endif
+}
+
+long currentRssKb() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, residentPages = 0;
+    if (statm >> pages >> residentPages) {
+        return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+#endif
+    return peakRssKb();
+}
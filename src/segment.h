@@ -0,0 +1,150 @@
+#ifndef SEGMENT_H
+#define SEGMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "indexer.h"
+
+// ============================================================
+// Binary index segments
+// ============================================================
+//
+// Layout (all integers after the header are LEB128 varints):
+//
+//   "ISEG" | u32 version | u64 termCount
+//   termCount x {
+//       termLen | term bytes | docCount
+//       docCount x { docGap | posCount | posCount x posGap }
+//   }
+//   termCount x {                                  (term directory)
+//       sharedPrefixLen | suffixLen | suffix bytes
+//       offsetGap | length | docCount | lastDocID + 1
+//   }
+//   u64 directory offset
+//
+// Terms are sorted lexicographically, docIDs ascending within a
+// term and positions ascending within a document. DocIDs and
+// positions are delta-encoded (first value relative to 0). The
+// directory gives each term's posting byte range, so a reader can
+// find a term without decoding the postings before it. Its terms
+// share a prefix with the previous term; offsetGap is relative to
+// the end of the previous term's postings. Version 1
+// segments have no directory and footer; they are still read.
+//
+// A segment "<name>" is accompanied by a doc table "<name>.docs":
+//
+//   "IDOC" | u32 version | { docID | length | pathLen | path }*
+//
+
+// Memory budget and scratch location for the streaming builder
+struct StreamBuildOptions {
+    std::size_t memoryBudgetBytes = 256u << 20;
+    std::string runDir;  // default: "<segment>.runs"
+};
+
+// Counters reported after a streaming build
+struct StreamBuildStats {
+    std::size_t docs = 0;
+    std::size_t bytesRead = 0;
+    std::size_t tokens = 0;
+    std::size_t runs = 0;
+    std::size_t terms = 0;
+    std::size_t segmentBytes = 0;
+    long long elapsedMs = 0;
+    long peakRssKb = 0;
+};
+
+// Writes an in-memory index as a single sorted segment
+bool writeSegment(
+    const std::string& filename,
+    const PositionalIndex& positionalIndex
+);
+
+// Reads a segment back into an in-memory index (replacing it)
+bool loadSegment(
+    const std::string& filename,
+    PositionalIndex& positionalIndex
+);
+
+// Same, decoding with numThreads threads. The file is read in one
+// sequential pass; terms are then split by the directory into
+// ranges of roughly equal bytes and each thread fills its own doc
+// maps.
+bool loadSegmentParallel(
+    const std::string& filename,
+    unsigned int numThreads,
+    PositionalIndex& positionalIndex
+);
+
+// One term of a segment image held in memory (read or mmap'd).
+// [offset, end) covers the term's postings, starting at its
+// first docGap; lastDocID is its largest docID.
+struct SegmentTermEntry {
+    std::string term;
+    std::size_t offset = 0;
+    std::size_t end = 0;
+    int docCount = 0;
+    int lastDocID = -1;
+};
+
+// Size of the "ISEG" header preceding the first term
+extern const std::size_t SEGMENT_HEADER_BYTES;
+
+// LEB128 decoding from memory; false on truncation
+bool decodeVarint(const unsigned char* data, std::size_t size, std::size_t& offset, uint64_t& value);
+
+// Validates the header and lists every term of a segment image from
+// its directory (version 1: by decoding every posting)
+bool readSegmentDirectory(
+    const unsigned char* data,
+    std::size_t size,
+    std::vector<SegmentTermEntry>& terms
+);
+
+// Writes / reads the doc table stored next to a segment
+bool writeDocTable(
+    const std::string& filename,
+    const std::unordered_map<int, std::string>& docIdToName,
+    const std::unordered_map<int, int>& docLength
+);
+
+bool loadDocTable(
+    const std::string& filename,
+    std::unordered_map<int, std::string>& docIdToName,
+    std::unordered_map<int, int>& docLength
+);
+
+// Indexes every regular file in dataDir without holding the corpus
+// in memory. Postings are accumulated until the memory budget is
+// reached, spilled as sorted runs and k-way merged into segmentFile.
+// Returns false on any I/O failure; the runs of a failed merge are
+// left in the run directory.
+bool buildSegmentStreaming(
+    const std::string& dataDir,
+    const std::string& segmentFile,
+    const StreamBuildOptions& options,
+    StreamBuildStats& stats
+);
+
+// Varint-encoded posting size of an index (segment layout)
+struct PostingSizeStats {
+    std::size_t postings = 0;
+    std::size_t docBytes = 0;       // docGap + posCount
+    std::size_t positionBytes = 0;  // position gaps
+};
+
+// Measures the compressed size an index would take in a segment,
+// with docIDs in ascending order as written by writeSegment()
+PostingSizeStats measurePostingSize(const PositionalIndex& positionalIndex);
+
+// Peak resident set size of this process in KiB
+long peakRssKb();
+
+// Current resident set size in KiB (peak where unavailable)
+long currentRssKb();
+
+#endif
@@ -0,0 +1,250 @@
+#include "snapshot.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "segment.h"
+
+namespace {
+
+// Reclaimer poll period while a retired snapshot is still in use
+const std::chrono::milliseconds RECLAIM_POLL(10);
+
+}  // namespace
+
+SnapshotManager::SnapshotManager()
+    : reclaimer_(&SnapshotManager::reclaimLoop, this) {}
+
+SnapshotManager::~SnapshotManager() {
+    waitForRebuild();
+
+    {
+        std::lock_guard<std::mutex> lock(reclaimMutex_);
+        stopping_ = true;
+    }
+    reclaimWake_.notify_all();
+    reclaimer_.join();
+
+    delete current_.load();
+}
+
+std::shared_ptr<const IndexSnapshot> SnapshotManager::acquire() const {
+    // Register under the current epoch; retry if a writer flipped it
+    // in between, since that writer may not wait for this slot
+    uint64_t epoch;
+    while (true) {
+        epoch = epoch_.load();
+        readers_[epoch & 1].count.fetch_add(1);
+        if (epoch_.load() == epoch) break;
+        readers_[epoch & 1].count.fetch_sub(1);
+    }
+
+    const Published* published = current_.load();
+    std::shared_ptr<const IndexSnapshot> snapshot =
+        published ? published->snapshot : nullptr;
+
+    readers_[epoch & 1].count.fetch_sub(1);
+    return snapshot;
+}
+
+uint64_t SnapshotManager::publish(std::shared_ptr<IndexSnapshot> next) {
+    std::lock_guard<std::mutex> lock(writerMutex_);
+
+    const uint64_t version = nextVersion_++;
+    next->version = version;
+
+    Published* previous = current_.exchange(new Published{std::move(next)});
+
+    // Readers that registered before the flip may still be copying
+    // from previous; later ones can only see the new slot
+    const uint64_t oldEpoch = epoch_.fetch_add(1);
+    while (readers_[oldEpoch & 1].count.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    if (previous) {
+        retired_.push_back(std::move(previous->snapshot));
+        delete previous;
+
+        {
+            std::lock_guard<std::mutex> wake(reclaimMutex_);
+            retiredPending_ = true;
+        }
+        reclaimWake_.notify_all();
+    }
+    return version;
+}
+
+bool SnapshotManager::reclaim() {
+    std::vector<std::shared_ptr<const IndexSnapshot>> unreferenced;
+    bool drained;
+    {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+
+        auto it = retired_.begin();
+        while (it != retired_.end()) {
+            // Only the retire list holds it: no query can reach it
+            if (it->use_count() == 1) {
+                unreferenced.push_back(std::move(*it));
+                it = retired_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        drained = retired_.empty();
+    }
+    // Destroyed here, outside the lock
+    return drained;
+}
+
+void SnapshotManager::reclaimLoop() {
+    std::unique_lock<std::mutex> lock(reclaimMutex_);
+
+    while (!stopping_) {
+        retiredPending_ = false;
+        lock.unlock();
+        bool drained = reclaim();
+        lock.lock();
+
+        // In-flight queries drain quickly; poll until they have
+        if (drained) {
+            reclaimWake_.wait(lock, [this] { return stopping_ || retiredPending_; });
+        } else {
+            reclaimWake_.wait_for(lock, RECLAIM_POLL, [this] { return stopping_; });
+        }
+    }
+}
+
+bool SnapshotManager::rebuildAsync(Builder build) {
+    bool expected = false;
+    if (!rebuilding_.compare_exchange_strong(expected, true)) {
+        return false;
+    }
+
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    worker_ = std::thread([this, build = std::move(build)]() {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::shared_ptr<IndexSnapshot> next = build();
+        if (next) {
+            uint64_t version = publish(std::move(next));
+
+            auto end = std::chrono::high_resolution_clock::now();
+            std::cerr << "[rebuild] snapshot v" << version << " published in "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
+                      << " ms\n";
+        } else {
+            std::cerr << "[rebuild] failed; keeping the current snapshot\n";
+        }
+
+        // The old snapshot is freed by the reclaimer, so the next
+        // rebuild can start right away
+        rebuilding_ = false;
+    });
+
+    return true;
+}
+
+void SnapshotManager::waitForRebuild() {
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+/* ============================================================
+   SNAPSHOT BUILDERS
+   ============================================================ */
+
+std::shared_ptr<IndexSnapshot> buildSnapshotFromDirectory(
+    const std::string& dataDir,
+    unsigned int numThreads,
+    ReorderMethod reorder
+) {
+    auto snapshot = std::make_shared<IndexSnapshot>();
+
+    std::vector<Document> documents = loadDocuments(dataDir);
+    buildIndexParallel(
+        documents,
+        numThreads,
+        snapshot->positionalIndex,
+        snapshot->docLength
+    );
+
+    for (const auto& doc : documents) {
+        snapshot->docIdToName[doc.id] = doc.path;
+    }
+
+    if (reorder != ReorderMethod::None) {
+        std::vector<int> newToOld = computeDocOrder(
+            reorder,
+            snapshot->positionalIndex,
+            snapshot->docIdToName,
+            static_cast<int>(documents.size())
+        );
+        documents = applyDocOrder(std::move(documents), newToOld);
+
+        buildIndexParallel(
+            documents,
+            numThreads,
+            snapshot->positionalIndex,
+            snapshot->docLength
+        );
+
+        snapshot->docIdToName.clear();
+        for (const auto& doc : documents) {
+            snapshot->docIdToName[doc.id] = doc.path;
+        }
+    }
+    snapshot->totalDocs = static_cast<int>(documents.size());
+
+    return snapshot;
+}
+
+std::shared_ptr<IndexSnapshot> loadSnapshotFromSegment(
+    const std::string& segment,
+    unsigned int numThreads
+) {
+    auto snapshot = std::make_shared<IndexSnapshot>();
+
+    // The doc table is independent of the postings: load it alongside
+    bool docsLoaded = false;
+    std::thread docLoader([&]() {
+        docsLoaded = loadDocTable(segment + ".docs", snapshot->docIdToName, snapshot->docLength);
+    });
+
+    bool segmentLoaded = loadSegmentParallel(segment, numThreads, snapshot->positionalIndex);
+    docLoader.join();
+
+    if (!segmentLoaded || !docsLoaded) {
+        std::cerr << "Error: Unable to load segment " << segment << "\n";
+        return nullptr;
+    }
+    snapshot->totalDocs = static_cast<int>(snapshot->docIdToName.size());
+
+    return snapshot;
+}
+
+std::shared_ptr<IndexSnapshot> openTieredSnapshot(
+    const std::string& segment,
+    std::size_t hotBudgetBytes
+) {
+    auto snapshot = std::make_shared<IndexSnapshot>();
+
+    bool docsLoaded = false;
+    std::thread docLoader([&]() {
+        docsLoaded = loadDocTable(segment + ".docs", snapshot->docIdToName, snapshot->docLength);
+    });
+    snapshot->tiered = TieredIndex::open(segment, hotBudgetBytes);
+    docLoader.join();
+
+    if (!snapshot->tiered || !docsLoaded) {
+        std::cerr << "Error: Unable to open " << segment << " / " << segment << ".docs\n";
+        return nullptr;
+    }
+    snapshot->totalDocs = static_cast<int>(snapshot->docIdToName.size());
+
+    return snapshot;
+}
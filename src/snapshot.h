@@ -0,0 +1,162 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "indexer.h"
+#include "pruning.h"
+#include "ranker.h"
+#include "reorder.h"
+#include "tiered_index.h"
+
+// ============================================================
+// DocID-range partition
+// ============================================================
+//
+// Slice of the index covering docs [docBegin, docEnd), with
+// docID-sorted postings. Built by its home worker so the memory
+// is first-touched on that worker's NUMA node.
+//
+struct IndexPartition {
+    int docBegin = 0;
+    int docEnd = 0;
+    unsigned int homeWorker = 0;
+    std::unordered_map<std::string, std::vector<Posting>> postings;
+    std::vector<int> lengths;  // docLength of docBegin + i
+};
+
+// ============================================================
+// Immutable index snapshot
+// ============================================================
+//
+// Everything a query needs, frozen after construction. Queries
+// hold a shared_ptr to the snapshot they started on, so a newer
+// snapshot can be published at any time without affecting them.
+//
+// A bootstrap snapshot (fast startup) has only the doc table and
+// a mmap'd TieredIndex: ranked queries are served from it while
+// the full snapshot is loaded in the background.
+//
+struct IndexSnapshot {
+    PositionalIndex positionalIndex;
+    std::unordered_map<int, int> docLength;
+    std::unordered_map<int, std::string> docIdToName;
+    std::vector<IndexPartition> partitions;  // empty until partitioned
+    PositionalIndex biwordIndex;             // empty unless enabled
+    PrunedIndex prunedIndex;                 // empty unless enabled
+    std::shared_ptr<TieredIndex> tiered;     // bootstrap snapshots only
+    int totalDocs = 0;
+    uint64_t version = 0;
+};
+
+// ============================================================
+// RCU-style snapshot publication
+// ============================================================
+//
+// - Readers: acquire() takes no lock. It registers in the reader
+//   count of the current epoch, loads the published pointer, copies
+//   the shared_ptr it holds and leaves; nothing blocks on a rebuild.
+// - Writers: a new snapshot is built off to the side (optionally
+//   on a background thread) and swapped in with one atomic store.
+//   The writer then flips the epoch and waits for the readers of
+//   the old epoch (each only copying a pointer) before freeing the
+//   old slot.
+// - Reclamation: the replaced snapshot is parked on a retire list
+//   and destroyed by a background reclaimer once no query holds it,
+//   so tearing down a large index never lands on a query thread and
+//   never delays the next rebuild.
+//
+class SnapshotManager {
+public:
+    using Builder = std::function<std::shared_ptr<IndexSnapshot>()>;
+
+    SnapshotManager();
+    ~SnapshotManager();
+
+    SnapshotManager(const SnapshotManager&) = delete;
+    SnapshotManager& operator=(const SnapshotManager&) = delete;
+
+    // Current snapshot (may be null before the first publish)
+    std::shared_ptr<const IndexSnapshot> acquire() const;
+
+    // Stamps a version on next and makes it current; returns the version
+    uint64_t publish(std::shared_ptr<IndexSnapshot> next);
+
+    // Runs build on a background thread and publishes the result
+    // (nothing is published if build returns null). Returns false
+    // if a rebuild is already in progress.
+    bool rebuildAsync(Builder build);
+
+    bool rebuilding() const { return rebuilding_.load(); }
+
+    // Blocks until a pending background rebuild has finished
+    void waitForRebuild();
+
+    // Destroys retired snapshots that no reader holds any more;
+    // true once the retire list is empty
+    bool reclaim();
+
+private:
+    // What readers reach through current_; freed only after the
+    // readers of its epoch have left
+    struct Published {
+        std::shared_ptr<const IndexSnapshot> snapshot;
+    };
+
+    struct alignas(64) ReaderCount {
+        std::atomic<long> count{0};
+    };
+
+    void reclaimLoop();
+
+    std::atomic<Published*> current_{nullptr};
+    std::atomic<uint64_t> epoch_{0};
+    mutable ReaderCount readers_[2];  // by epoch parity
+
+    std::atomic<uint64_t> nextVersion_{1};
+    std::atomic<bool> rebuilding_{false};
+
+    std::mutex writerMutex_;  // serializes writers only
+    std::vector<std::shared_ptr<const IndexSnapshot>> retired_;
+    std::thread worker_;
+
+    std::mutex reclaimMutex_;
+    std::condition_variable reclaimWake_;
+    bool retiredPending_ = false;
+    bool stopping_ = false;
+    std::thread reclaimer_;
+};
+
+// Loads and indexes dataDir into a fresh snapshot, optionally
+// reassigning docIDs (which indexes the corpus twice)
+std::shared_ptr<IndexSnapshot> buildSnapshotFromDirectory(
+    const std::string& dataDir,
+    unsigned int numThreads,
+    ReorderMethod reorder = ReorderMethod::None
+);
+
+// Loads "<segment>" (decoded with numThreads threads) and, in
+// parallel, "<segment>.docs"; null on failure
+std::shared_ptr<IndexSnapshot> loadSnapshotFromSegment(
+    const std::string& segment,
+    unsigned int numThreads = 1
+);
+
+// Maps "<segment>" as a TieredIndex (hot cache of hotBudgetBytes)
+// and loads "<segment>.docs" alongside; ranked queries only, the
+// positional index stays empty. Null on failure.
+std::shared_ptr<IndexSnapshot> openTieredSnapshot(
+    const std::string& segment,
+    std::size_t hotBudgetBytes
+);
+
+#endif
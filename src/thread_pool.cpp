@@ -0,0 +1,261 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace fs = std::filesystem;
+
+/* ============================================================
+   CPU / NUMA TOPOLOGY
+   ============================================================ */
+
+namespace {
+
+// Parses a sysfs cpulist such as "0-3,8-11"
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) continue;
+
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last  = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        } catch (...) {
+            // malformed entry: ignore
+        }
+    }
+    return cpus;
+}
+
+// False if the OS refused the affinity (or has no such API)
+bool pinToCpu(std::thread& thread, int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)cpu;  // macOS has no hard affinity API
+    return false;
+#endif
+}
+
+// Drops CPUs outside the process affinity mask (taskset, cgroups)
+void keepAllowedCpus(std::vector<std::pair<int, int>>& cpus) {
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+
+    std::vector<std::pair<int, int>> kept;
+    for (const auto& cpu : cpus) {
+        if (cpu.first >= 0 && cpu.first < CPU_SETSIZE && CPU_ISSET(cpu.first, &allowed)) {
+            kept.push_back(cpu);
+        }
+    }
+    if (kept.empty()) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) kept.emplace_back(cpu, 0);
+        }
+    }
+    if (!kept.empty()) cpus.swap(kept);
+#else
+    (void)cpus;
+#endif
+}
+
+}  // namespace
+
+std::vector<std::pair<int, int>> cpusByNumaNode() {
+    std::vector<std::pair<int, int>> cpus;  // {cpu, node}
+
+    const fs::path nodeRoot = "/sys/devices/system/node";
+    std::error_code ec;
+
+    if (fs::is_directory(nodeRoot, ec)) {
+        std::vector<int> nodes;
+        for (const auto& entry : fs::directory_iterator(nodeRoot, ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind("node", 0) == 0 && name.size() > 4 &&
+                std::isdigit(static_cast<unsigned char>(name[4]))) {
+                nodes.push_back(std::stoi(name.substr(4)));
+            }
+        }
+        std::sort(nodes.begin(), nodes.end());
+
+        for (int node : nodes) {
+            std::ifstream in(nodeRoot / ("node" + std::to_string(node)) / "cpulist");
+            std::string list;
+            std::getline(in, list);
+            for (int cpu : parseCpuList(list)) cpus.emplace_back(cpu, node);
+        }
+    }
+
+    if (cpus.empty()) {
+        unsigned int n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int cpu = 0; cpu < n; cpu++) cpus.emplace_back(cpu, 0);
+    }
+    keepAllowedCpus(cpus);
+    return cpus;
+}
+
+/* ============================================================
+   WORK-STEALING POOL
+   ============================================================ */
+
+WorkStealingPool::WorkStealingPool(unsigned int numWorkers, bool pinThreads) {
+    if (numWorkers == 0) numWorkers = 1;
+
+    std::vector<std::pair<int, int>> cpus = cpusByNumaNode();
+
+    for (unsigned int i = 0; i < numWorkers; i++) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    // More workers than usable CPUs: let the OS place them
+    bool pin = pinThreads && numWorkers <= cpus.size();
+
+    for (unsigned int i = 0; i < numWorkers; i++) {
+        threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        if (pin && !pinToCpu(threads_.back(), cpus[i].first)) {
+            std::cerr << "Warning: unable to pin query worker " << i << " to CPU "
+                      << cpus[i].first << "; workers left unpinned\n";
+            pin = false;
+        }
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+
+void WorkStealingPool::submit(unsigned int preferredWorker, std::function<void()> task) {
+    WorkerQueue& queue = *queues_[preferredWorker % queues_.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        pending_++;
+    }
+    wakeup_.notify_all();
+}
+
+void WorkStealingPool::submitPinned(unsigned int worker, std::function<void()> task) {
+    WorkerQueue& queue = *queues_[worker % queues_.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.pinned.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        queue.pinnedPending++;
+    }
+    wakeup_.notify_all();
+}
+
+bool WorkStealingPool::popPinned(unsigned int self, std::function<void()>& task) {
+    WorkerQueue& queue = *queues_[self];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.pinned.empty()) return false;
+        task = std::move(queue.pinned.front());
+        queue.pinned.pop_front();
+    }
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    queue.pinnedPending--;
+    return true;
+}
+
+bool WorkStealingPool::popLocal(unsigned int self, std::function<void()>& task) {
+    WorkerQueue& queue = *queues_[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned int self, std::function<void()>& task) {
+    // Scan victims starting next to self so thieves spread out
+    for (size_t offset = 1; offset < queues_.size(); offset++) {
+        WorkerQueue& victim = *queues_[(self + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned int self) {
+    std::function<void()> task;
+    const WorkerQueue& own = *queues_[self];
+
+    while (true) {
+        if (popPinned(self, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        if (popLocal(self, task) || steal(self, task)) {
+            pending_--;
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wakeup_.wait(lock, [this, &own] {
+            return stopping_ || pending_.load() > 0 || own.pinnedPending > 0;
+        });
+        if (stopping_ && pending_.load() == 0 && own.pinnedPending == 0) return;
+    }
+}
+
+/* ============================================================
+   TASK GROUP
+   ============================================================ */
+
+void TaskGroup::add(int n) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    remaining_ += n;
+}
+
+void TaskGroup::done() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--remaining_ == 0) cv_.notify_all();
+}
+
+void TaskGroup::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return remaining_ == 0; });
+}
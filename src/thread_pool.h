@@ -0,0 +1,90 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================
+// Work-stealing thread pool
+// ============================================================
+//
+// - One task deque per worker. A worker pops from the back of its
+//   own deque (LIFO, cache-warm) and steals from the front of the
+//   others when it runs dry.
+// - submit() targets a preferred worker so work tied to a given
+//   index partition keeps landing on the same core. submitPinned()
+//   queues a task only that worker may run (never stolen), for
+//   work whose placement matters (first-touch allocation).
+// - Workers are pinned to the CPUs this process may run on
+//   (sched_getaffinity), ordered by NUMA node (Linux only).
+//
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned int numWorkers, bool pinThreads = true);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned int size() const { return static_cast<unsigned int>(queues_.size()); }
+
+    void submit(unsigned int preferredWorker, std::function<void()> task);
+
+    // Runs task on worker (modulo size()) and nowhere else
+    void submitPinned(unsigned int worker, std::function<void()> task);
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+        std::deque<std::function<void()>> pinned;  // owner only
+        long pinnedPending = 0;                    // guarded by sleepMutex_
+    };
+
+    void workerLoop(unsigned int self);
+    bool popPinned(unsigned int self, std::function<void()>& task);
+    bool popLocal(unsigned int self, std::function<void()>& task);
+    bool steal(unsigned int self, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex sleepMutex_;
+    std::condition_variable wakeup_;
+    std::atomic<long> pending_{0};  // stealable tasks; may dip below 0 briefly
+    bool stopping_ = false;
+};
+
+// ============================================================
+// Task group (fork/join latch)
+// ============================================================
+//
+// Counts outstanding tasks so the submitting thread can run its
+// own share of the work and then wait for the rest. The counter
+// only changes under the mutex, so wait() cannot return (and the
+// group go out of scope) while done() is still notifying.
+//
+class TaskGroup {
+public:
+    void add(int n = 1);
+    void done();
+    void wait();
+
+private:
+    int remaining_ = 0;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+// Logical CPUs ordered node by node (sysfs on Linux, else 0..n-1),
+// paired with the NUMA node of each CPU. Restricted to the CPUs in
+// the process affinity mask when it is available.
+std::vector<std::pair<int, int>> cpusByNumaNode();
+
+#endif
@@ -0,0 +1,228 @@
+#include "tiered_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "segment.h"
+
+/* ============================================================
+   OPEN: MAP THE SEGMENT, READ THE TERM DIRECTORY
+   ============================================================ */
+
+std::unique_ptr<TieredIndex> TieredIndex::open(
+    const std::string& segmentFile,
+    std::size_t hotBudgetBytes
+) {
+    int fd = ::open(segmentFile.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Unable to open " << segmentFile << "\n";
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < SEGMENT_HEADER_BYTES) {
+        std::cerr << "Error: Not a segment file " << segmentFile << "\n";
+        ::close(fd);
+        return nullptr;
+    }
+
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps the file referenced
+
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error: Unable to map " << segmentFile << "\n";
+        return nullptr;
+    }
+
+    // Lookups jump between terms, so readahead would mostly be wasted
+    madvise(mapped, size, MADV_RANDOM);
+
+    std::unique_ptr<TieredIndex> index(new TieredIndex());
+    index->data_ = static_cast<const unsigned char*>(mapped);
+    index->size_ = size;
+    index->hotBudget_ = hotBudgetBytes;
+
+    std::vector<SegmentTermEntry> terms;
+    if (!readSegmentDirectory(index->data_, size, terms)) {
+        std::cerr << "Error: Corrupt segment " << segmentFile << "\n";
+        return nullptr;
+    }
+
+    index->directory_.reserve(terms.size());
+    for (auto& entry : terms) {
+        index->docLimit_ = std::max(index->docLimit_, entry.lastDocID + 1);
+        index->directory_.emplace(
+            std::move(entry.term),
+            TermEntry{entry.offset, entry.end, entry.docCount, entry.lastDocID}
+        );
+    }
+
+    // Drop the directory pages: the map above holds its contents
+    madvise(mapped, size, MADV_DONTNEED);
+
+    return index;
+}
+
+TieredIndex::~TieredIndex() {
+    if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+/* ============================================================
+   LOOKUP (HOT CACHE, THEN DECODE FROM THE MAPPING)
+   ============================================================ */
+
+int TieredIndex::docFrequency(const std::string& term) const {
+    auto it = directory_.find(term);
+    return it == directory_.end() ? 0 : it->second.docCount;
+}
+
+std::shared_ptr<const std::vector<Posting>> TieredIndex::decode(const TermEntry& entry) const {
+    auto list = std::make_shared<std::vector<Posting>>();
+    list->reserve(entry.docCount);
+
+    if (entry.docCount > 0 && entry.lastDocID < 0) return nullptr;
+
+    std::size_t offset = entry.offset;
+    int64_t docID = 0;
+
+    for (int d = 0; d < entry.docCount; d++) {
+        uint64_t gap = 0, posCount = 0, skipped = 0;
+        if (!decodeVarint(data_, entry.end, offset, gap) ||
+            !decodeVarint(data_, entry.end, offset, posCount)) {
+            return nullptr;
+        }
+
+        // DocIDs strictly increase up to the directory's last docID
+        if ((d > 0 && gap == 0) || gap > static_cast<uint64_t>(entry.lastDocID - docID)) {
+            return nullptr;
+        }
+        docID += static_cast<int64_t>(gap);
+
+        // Each position takes at least one byte
+        if (posCount > entry.end - offset) return nullptr;
+
+        // Ranked queries only need the TF; skip the positions
+        for (uint64_t p = 0; p < posCount; p++) {
+            if (!decodeVarint(data_, entry.end, offset, skipped)) return nullptr;
+        }
+
+        list->push_back({static_cast<int>(docID), static_cast<int>(posCount)});
+    }
+
+    if (entry.docCount > 0 && docID != entry.lastDocID) return nullptr;
+    return list;
+}
+
+std::size_t TieredIndex::prefetch(const std::vector<std::string>& terms) const {
+    const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t advised = 0;
+
+    for (const auto& term : terms) {
+        auto it = directory_.find(term);
+        if (it == directory_.end()) continue;
+
+        // madvise needs a page-aligned start
+        std::size_t begin = it->second.offset / pageSize * pageSize;
+        std::size_t length = it->second.end - begin;
+
+        if (madvise(const_cast<unsigned char*>(data_) + begin, length, MADV_WILLNEED) == 0) {
+            advised += it->second.end - it->second.offset;
+        }
+    }
+    return advised;
+}
+
+bool TieredIndex::postings(const std::string& term, std::shared_ptr<const std::vector<Posting>>& list) {
+    {
+        std::lock_guard<std::mutex> lock(hotMutex_);
+        auto hit = hot_.find(term);
+        if (hit != hot_.end()) {
+            lru_.splice(lru_.begin(), lru_, hit->second.lruPosition);
+            hits_++;
+            list = hit->second.postings;
+            return true;
+        }
+    }
+
+    list = nullptr;
+    auto it = directory_.find(term);
+    if (it == directory_.end()) return true;
+
+    misses_++;
+    list = decode(it->second);
+    if (!list) {
+        std::cerr << "Error: Corrupt postings for term \"" << term << "\" in the mapped segment\n";
+        return false;
+    }
+
+    const std::size_t bytes = list->capacity() * sizeof(Posting) + term.capacity();
+    if (bytes > hotBudget_) return true;
+
+    std::lock_guard<std::mutex> lock(hotMutex_);
+    if (hot_.count(term)) return true;  // another query admitted it first
+
+    while (hotBytes_ + bytes > hotBudget_ && !lru_.empty()) {
+        auto victim = hot_.find(lru_.back());
+        hotBytes_ -= victim->second.bytes;
+        hot_.erase(victim);
+        lru_.pop_back();
+        evictions_++;
+    }
+
+    lru_.push_front(term);
+    hot_.emplace(term, HotEntry{list, bytes, lru_.begin()});
+    hotBytes_ += bytes;
+
+    return true;
+}
+
+/* ============================================================
+   RANKING
+   ============================================================ */
+
+bool TieredIndex::rank(
+    const std::vector<std::string>& queryTokens,
+    const std::unordered_map<int,int>& docLength,
+    int totalDocs,
+    int K,
+    std::vector<std::pair<int,double>>& results,
+    QueryBudget* budget
+) {
+    // Holds the decoded lists alive for the duration of the query
+    std::vector<std::shared_ptr<const std::vector<Posting>>> owned(queryTokens.size());
+    std::vector<const std::vector<Posting>*> lists;
+    std::vector<double> idfs;
+
+    results.clear();
+    for (std::size_t t = 0; t < queryTokens.size(); t++) {
+        if (!postings(queryTokens[t], owned[t])) return false;
+        lists.push_back(owned[t].get());
+        idfs.push_back(computeIDF(totalDocs, docFrequency(queryTokens[t])));
+    }
+
+    results = rankDocumentRange(lists, idfs, docLength, 0, docLimit_, K, budget);
+    return true;
+}
+
+TieredIndex::Stats TieredIndex::stats() const {
+    Stats s;
+    s.hits      = hits_.load();
+    s.misses    = misses_.load();
+    s.evictions = evictions_.load();
+    s.mappedBytes = size_;
+
+    {
+        std::lock_guard<std::mutex> lock(hotMutex_);
+        s.hotTerms = hot_.size();
+        s.hotBytes = hotBytes_;
+    }
+
+    return s;
+}
@@ -0,0 +1,120 @@
+#ifndef TIERED_INDEX_H
+#define TIERED_INDEX_H
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ranker.h"
+
+// ============================================================
+// Tiered hot/cold index residency
+// ============================================================
+//
+// Serves ranked queries from a segment file (see segment.h)
+// under a RAM budget for decoded postings:
+//
+// - Cold: the segment is mmap'd read-only; a term's postings stay
+//   varint-compressed on disk and the kernel pages them in on the
+//   first lookup. Only the term directory (term -> byte range),
+//   read from the end of the segment at open, is kept in RAM.
+// - Hot: decoded docID-sorted postings of recently used terms,
+//   kept in an LRU cache bounded by hotBudgetBytes. A term whose
+//   postings alone exceed the budget is decoded per query.
+//
+// Results are identical to rankDocuments() on the same index.
+// Thread-safe: queries may share one TieredIndex.
+//
+class TieredIndex {
+public:
+    struct Stats {
+        unsigned long long hits = 0;
+        unsigned long long misses = 0;
+        unsigned long long evictions = 0;
+        std::size_t hotTerms = 0;
+        std::size_t hotBytes = 0;
+        std::size_t mappedBytes = 0;
+    };
+
+    // Maps segmentFile and reads its term directory; null on failure
+    static std::unique_ptr<TieredIndex> open(
+        const std::string& segmentFile,
+        std::size_t hotBudgetBytes
+    );
+
+    ~TieredIndex();
+
+    TieredIndex(const TieredIndex&) = delete;
+    TieredIndex& operator=(const TieredIndex&) = delete;
+
+    std::size_t termCount() const { return directory_.size(); }
+
+    // One past the largest docID in the segment
+    int docLimit() const { return docLimit_; }
+
+    // Number of docs containing term (from the directory, no decode)
+    int docFrequency(const std::string& term) const;
+
+    // Asks the kernel to read the terms' postings ahead of use
+    // (MADV_WILLNEED, asynchronous). Returns the bytes advised.
+    std::size_t prefetch(const std::vector<std::string>& terms) const;
+
+    // DocID-sorted postings of term (null if absent). False if the
+    // mapped postings are corrupt.
+    bool postings(const std::string& term, std::shared_ptr<const std::vector<Posting>>& list);
+
+    // TF-IDF Top-K (same results as rankDocuments). False, with no
+    // results, if a query term's postings are corrupt.
+    bool rank(
+        const std::vector<std::string>& queryTokens,
+        const std::unordered_map<int,int>& docLength,
+        int totalDocs,
+        int K,
+        std::vector<std::pair<int,double>>& results,
+        QueryBudget* budget = nullptr
+    );
+
+    Stats stats() const;
+
+private:
+    struct TermEntry {
+        std::size_t offset = 0;  // first docGap of the term
+        std::size_t end = 0;     // one past its last posting byte
+        int docCount = 0;
+        int lastDocID = -1;
+    };
+
+    struct HotEntry {
+        std::shared_ptr<const std::vector<Posting>> postings;
+        std::size_t bytes = 0;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    TieredIndex() = default;
+
+    // Null if the postings do not match the directory entry
+    std::shared_ptr<const std::vector<Posting>> decode(const TermEntry& entry) const;
+
+    const unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+    int docLimit_ = 0;
+    std::unordered_map<std::string, TermEntry> directory_;
+
+    std::size_t hotBudget_ = 0;
+    mutable std::mutex hotMutex_;
+    std::unordered_map<std::string, HotEntry> hot_;
+    std::list<std::string> lru_;  // front = most recently used
+    std::size_t hotBytes_ = 0;
+
+    std::atomic<unsigned long long> hits_{0};
+    std::atomic<unsigned long long> misses_{0};
+    std::atomic<unsigned long long> evictions_{0};
+};
+
+#endif